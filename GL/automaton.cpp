@@ -0,0 +1,66 @@
+#include "automaton.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+moveAutomaton::moveAutomaton(uint64_t moveMask)
+	: mask(moveMask & allMoves)
+{
+	octaState ab, ba;
+	int a, b, m, last, state;
+	bool repeated;
+	if (!mask || (mask & 0x5555555555ull) != (mask >> 1 & 0x5555555555ull))
+		throw std::invalid_argument("a move set needs both turns of each id");
+	for (a = 0; a < moveCount; ++a)
+		for (b = 0; b < moveCount; ++b)
+		{
+			ab.reset();
+			applyMove(ab, a);
+			applyMove(ab, b);
+			ba.reset();
+			applyMove(ba, b);
+			applyMove(ba, a);
+			commute[a][b] = ab == ba;
+		}
+	for (state = 0; state < stateCount; ++state)
+	{
+		last = state ? (state - 1) / 2 : -1;
+		repeated = state && (state - 1) % 2;
+		for (m = 0; m < moveCount; ++m)
+		{
+			table[state][m] = (signed char)(1 + 2 * m);
+			if (!(mask >> m & 1))
+				table[state][m] = -1;
+			if (last < 0 || !(mask >> m & 1))
+				continue;
+			if (m == last)
+			{
+				// Twice the same 120-degree turn is its inverse, and a half
+				// turn of a 90-degree turn is only written with the positive
+				// move.
+				if (moveOrder(m) == 3 || moveShift(m) < 0 || repeated)
+					table[state][m] = -1;
+				else
+					table[state][m] = (signed char)(2 + 2 * m);
+			}
+			else if (m == (last ^ 1) || (commute[last][m] && moveId(m) < moveId(last)))
+				table[state][m] = -1;
+		}
+	}
+}
+// The full set is asked for on every search node, so it skips the lock.
+const moveAutomaton& moveAutomaton::get(uint64_t moveMask)
+{
+	static const moveAutomaton full(allMoves);
+	static std::mutex lock;
+	static std::map<uint64_t, std::unique_ptr<moveAutomaton>> built;
+	if (moveMask == allMoves)
+		return full;
+	std::lock_guard<std::mutex> hold(lock);
+	std::unique_ptr<moveAutomaton>& a = built[moveMask];
+	if (!a)
+		a.reset(new moveAutomaton(moveMask));
+	return *a;
+}
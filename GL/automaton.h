@@ -0,0 +1,47 @@
+#pragma once
+#include "moves.h"
+
+// Finite automaton accepting only canonical move sequences. A state is the
+// last move and whether it was just repeated. A move is rejected when it
+// undoes the last one, repeats a turn past half its order, or commutes with
+// the last move and sorts before it (by addTask id), so of every run of
+// commuting moves only one order is searched. Every sequence can be brought
+// to an accepted one of no greater length, so searches stay optimal.
+//
+// Which moves commute is found by composing them both ways. Moves about one
+// axis (a corner's tip twist and inner-layer turn, or the turns of opposite
+// faces or corners) need no rule of their own: they commute, so the test
+// already keeps only one order of them.
+//
+// An automaton can be limited to a move set holding both turns of each of
+// its ids; moves outside it are always rejected. Automata are built once per
+// set and shared.
+class moveAutomaton
+{
+private:
+	static const int stateCount = 1 + 2 * moveCount;
+	bool commute[moveCount][moveCount];
+	signed char table[stateCount][moveCount];
+	uint64_t mask;
+	explicit moveAutomaton(uint64_t moveMask);
+public:
+	static const int start = 0;
+	static const moveAutomaton& get(uint64_t moveMask = allMoves);
+	// The state after move m, or -1 if m is not canonical there.
+	int next(int state, int m) const
+	{
+		return table[state][m];
+	}
+	bool commutes(int a, int b) const
+	{
+		return commute[a][b];
+	}
+	int states() const
+	{
+		return stateCount;
+	}
+	uint64_t moves() const
+	{
+		return mask;
+	}
+};
@@ -0,0 +1,154 @@
+#include "batch.h"
+#include "moves.h"
+#include "rotation.h"
+
+#include <cstring>
+
+// An odd number of cache lines, so consecutive rows land in different sets.
+static size_t rowStride(size_t n)
+{
+	size_t lines = (n + 63) / 64;
+	return (lines | 1) * 64;
+}
+
+octaBatch::octaBatch(size_t count) : n(count), stride(rowStride(count)), posData(42 * stride), oriData(42 * stride)
+{
+	reset();
+}
+void octaBatch::reset()
+{
+	int i;
+	for (i = 0; i < 42; ++i)
+	{
+		posRow[i] = i;
+		oriRow[i] = i;
+		std::memset(posData.data() + i * stride, i, n);
+	}
+	std::memset(oriData.data(), 0, oriData.size());
+}
+void octaBatch::set(size_t k, const octaState& s)
+{
+	int i;
+	for (i = 0; i < 42; ++i)
+	{
+		posData[posRow[i] * stride + k] = s.pos[i];
+		oriData[oriRow[i] * stride + k] = s.ori[i];
+	}
+}
+octaState octaBatch::get(size_t k) const
+{
+	octaState s;
+	int i;
+	for (i = 0; i < 42; ++i)
+	{
+		s.pos[i] = posData[posRow[i] * stride + k];
+		s.ori[i] = oriData[oriRow[i] * stride + k];
+	}
+	return s;
+}
+void octaBatch::apply(int m)
+{
+	int p[42], o[42], i, r = moveRotation(m);
+	for (i = 0; i < 42; ++i)
+	{
+		p[i] = posRow[moves.perm[m][i]];
+		o[i] = oriRow[moves.perm[m][i]];
+	}
+	for (i = 0; i < 42; ++i)
+	{
+		posRow[i] = p[i];
+		oriRow[i] = o[i];
+		if (moves.turn[m][i])
+			twistOrientations(r, oriData.data() + oriRow[i] * stride, n);
+	}
+}
+void octaBatch::apply(const octaState& t)
+{
+	int p[42], o[42], i;
+	for (i = 0; i < 42; ++i)
+	{
+		p[i] = posRow[t.pos[i]];
+		o[i] = oriRow[t.pos[i]];
+	}
+	for (i = 0; i < 42; ++i)
+	{
+		posRow[i] = p[i];
+		oriRow[i] = o[i];
+		twistOrientations(t.ori[i], oriData.data() + oriRow[i] * stride, n);
+	}
+}
+// m[k] is the move for state k, or -1 to leave it alone. Each state only
+// reads and rewrites the slots its own move turns, in place.
+void octaBatch::apply(const int* m)
+{
+	static const struct turnList
+	{
+		int count[moveCount];
+		int slot[moveCount][15];
+		int src[moveCount][15];
+		int rot[moveCount];
+		turnList()
+		{
+			int mv, i;
+			for (mv = 0; mv < moveCount; ++mv)
+			{
+				count[mv] = 0;
+				rot[mv] = moveRotation(mv);
+				for (i = 0; i < 42; ++i)
+					if (moves.turn[mv][i])
+					{
+						slot[mv][count[mv]] = i;
+						src[mv][count[mv]] = moves.perm[mv][i];
+						++count[mv];
+					}
+			}
+		}
+	} list;
+	const rotationGroup& g = rotationGroup::get();
+	unsigned char* p[42];
+	unsigned char* o[42];
+	unsigned char tp[15], to[15];
+	size_t k;
+	int i, j, mv;
+	for (i = 0; i < 42; ++i)
+	{
+		p[i] = posData.data() + posRow[i] * stride;
+		o[i] = oriData.data() + oriRow[i] * stride;
+	}
+	for (k = 0; k < n; ++k)
+	{
+		mv = m[k];
+		if (mv < 0)
+			continue;
+		for (j = 0; j < list.count[mv]; ++j)
+		{
+			i = list.src[mv][j];
+			tp[j] = p[i][k];
+			to[j] = o[i][k];
+		}
+		for (j = 0; j < list.count[mv]; ++j)
+		{
+			i = list.slot[mv][j];
+			p[i][k] = tp[j];
+			o[i][k] = g.mul(list.rot[mv], to[j]);
+		}
+	}
+}
+size_t octaBatch::countSolved() const
+{
+	std::vector<unsigned char> ok(n, 1);
+	const unsigned char* p;
+	const unsigned char* o;
+	size_t k, c = 0;
+	int i;
+	for (i = 0; i < 42; ++i)
+	{
+		p = pos(i);
+		o = ori(i);
+		for (k = 0; k < n; ++k)
+			ok[k] &= (p[k] == i) & (o[k] == 0);
+	}
+	for (k = 0; k < n; ++k)
+		c += ok[k];
+	return c;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "octaState.h"
+
+#include <cstddef>
+#include <vector>
+
+// N puzzle states stored slot-major: row i holds pos (or ori) of slot i for
+// every state, so one move turns into row moves plus a table lookup over the
+// rows it rotates. Rows are reached through posRow/oriRow, which a shared move
+// merely permutes.
+class octaBatch
+{
+private:
+	size_t n;
+	size_t stride;
+	std::vector<unsigned char> posData;
+	std::vector<unsigned char> oriData;
+	int posRow[42];
+	int oriRow[42];
+public:
+	explicit octaBatch(size_t count);
+	size_t size() const
+	{
+		return n;
+	}
+	const unsigned char* pos(int slot) const
+	{
+		return posData.data() + posRow[slot] * stride;
+	}
+	const unsigned char* ori(int slot) const
+	{
+		return oriData.data() + oriRow[slot] * stride;
+	}
+	void reset();
+	void set(size_t k, const octaState& s);
+	octaState get(size_t k) const;
+	void apply(int m);
+	void apply(const octaState& t);
+	void apply(const int* m);
+	size_t countSolved() const;
+};
@@ -0,0 +1,307 @@
+#include "bidirectional.h"
+#include "orbit.h"
+#include "stabilizer.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	const uint64_t keyMask = (1ull << 50) - 1;
+	const uint64_t ready = 1ull << 63;
+	const uint64_t busy = 1;
+	const int sideShift = 62, depthShift = 56, lastShift = 50;
+	const int rootMove = 63;
+	const uint64_t chunkSize = 256;
+
+	uint64_t meta(int side, int depth, int m)
+	{
+		return (uint64_t)side << sideShift | (uint64_t)depth << depthShift | (uint64_t)m << lastShift;
+	}
+	int sideOf(uint64_t w)
+	{
+		return (int)(w >> sideShift & 1);
+	}
+	int depthOf(uint64_t w)
+	{
+		return (int)(w >> depthShift & 63);
+	}
+	int moveOf(uint64_t w)
+	{
+		return (int)(w >> lastShift & 63);
+	}
+	uint64_t hashKey(const uint64_t* key)
+	{
+		uint64_t h = key[0];
+		int i;
+		for (i = 1; i < 4; ++i)
+		{
+			h = (h ^ key[i]) * 0x9e3779b97f4a7c15ull;
+			h ^= h >> 31;
+		}
+		return h;
+	}
+	int bitsFor(int n)
+	{
+		int b = 0;
+		while ((1 << b) < n)
+			++b;
+		return b;
+	}
+}
+
+// A field never straddles the metadata bits at the top of the first word.
+bidirectionalSolver::bidirectionalSolver(int threads, uint64_t capacity)
+	: capacity(capacity), threads(threads), used(0)
+{
+	const orbitTable& orbits = orbitTable::get();
+	int x, q = 0;
+	if (capacity < 64 || (capacity & (capacity - 1)))
+		throw std::invalid_argument("table capacity must be a power of two");
+	if (this->threads <= 0)
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	for (x = 0; x < 42; ++x)
+	{
+		const orbitInfo& o = orbits.orbit(orbits.orbitOfSlot(x));
+		pieceBits[x] = bitsFor(o.size);
+		width[x] = pieceBits[x] + bitsFor(o.twists);
+		if (q < 64 && q + width[x] > lastShift)
+			q = 64;
+		offset[x] = q;
+		q += width[x];
+	}
+	if (q > 256)
+		throw std::logic_error("packed state does not fit in four words");
+	table.reset(new std::atomic<uint64_t>[4 * capacity]);
+}
+
+void bidirectionalSolver::pack(const octaState& s, uint64_t* key) const
+{
+	const orbitTable& orbits = orbitTable::get();
+	uint64_t v;
+	int x, q;
+	key[0] = key[1] = key[2] = key[3] = 0;
+	for (x = 0; x < 42; ++x)
+	{
+		v = (uint64_t)orbits.indexOfSlot(s.pos[x]) | (uint64_t)orbits.digit(s, x) << pieceBits[x];
+		q = offset[x];
+		key[q >> 6] |= v << (q & 63);
+		if ((q & 63) + width[x] > 64)
+			key[(q >> 6) + 1] |= v >> (64 - (q & 63));
+	}
+}
+void bidirectionalSolver::unpack(const uint64_t* key, octaState& s) const
+{
+	const orbitTable& orbits = orbitTable::get();
+	uint64_t v;
+	int x, q, piece;
+	for (x = 0; x < 42; ++x)
+	{
+		q = offset[x];
+		v = key[q >> 6] >> (q & 63);
+		if ((q & 63) + width[x] > 64)
+			v |= key[(q >> 6) + 1] << (64 - (q & 63));
+		v &= (1ull << width[x]) - 1;
+		piece = orbits.orbit(orbits.orbitOfSlot(x)).slot[v & ((1ull << pieceBits[x]) - 1)];
+		s.pos[x] = (unsigned char)piece;
+		s.ori[x] = (unsigned char)orbits.rotation(x, piece, (int)(v >> pieceBits[x]));
+	}
+}
+
+// The slot holding key, claimed for it with meta if it was not there, or
+// capacity when every slot holds another key.
+uint64_t bidirectionalSolver::insert(const uint64_t* key, uint64_t meta, bool& fresh)
+{
+	uint64_t mask = capacity - 1, i = hashKey(key) & mask, w, probes;
+	std::atomic<uint64_t>* slot;
+	fresh = false;
+	for (probes = 0; probes < capacity; ++probes, i = (i + 1) & mask)
+	{
+		slot = &table[4 * i];
+		w = slot[0].load(std::memory_order_acquire);
+		if (w == 0 && slot[0].compare_exchange_strong(w, busy, std::memory_order_acquire))
+		{
+			slot[1].store(key[1], std::memory_order_relaxed);
+			slot[2].store(key[2], std::memory_order_relaxed);
+			slot[3].store(key[3], std::memory_order_relaxed);
+			slot[0].store(key[0] | meta | ready, std::memory_order_release);
+			used.fetch_add(1, std::memory_order_relaxed);
+			fresh = true;
+			return i;
+		}
+		while (!(w & ready))
+			w = slot[0].load(std::memory_order_acquire);
+		if ((w & keyMask) == key[0] && slot[1].load(std::memory_order_relaxed) == key[1]
+			&& slot[2].load(std::memory_order_relaxed) == key[2] && slot[3].load(std::memory_order_relaxed) == key[3])
+		{
+			return i;
+		}
+	}
+	return capacity;
+}
+uint64_t bidirectionalSolver::find(const octaState& s) const
+{
+	uint64_t key[4], mask = capacity - 1, i, w;
+	pack(s, key);
+	for (i = hashKey(key) & mask;; i = (i + 1) & mask)
+	{
+		w = table[4 * i].load(std::memory_order_relaxed);
+		if (w == 0)
+			throw std::logic_error("state missing from the table");
+		if ((w & keyMask) == key[0] && table[4 * i + 1] == key[1] && table[4 * i + 2] == key[2] && table[4 * i + 3] == key[3])
+			return i;
+	}
+}
+// The moves from the root of the side that reached s.
+std::vector<int> bidirectionalSolver::trace(octaState s) const
+{
+	std::vector<int> path;
+	uint64_t w;
+	int m;
+	for (;;)
+	{
+		w = table[4 * find(s)].load(std::memory_order_relaxed);
+		if (depthOf(w) == 0)
+			break;
+		m = moveOf(w);
+		path.push_back(m);
+		applyMove(s, m ^ 1);
+	}
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+// Side 0 grows from the scramble and side 1 from solved. Each step expands
+// both frontiers at once, so the shortest meeting it can find is one longer
+// than the two depths so far; once a thread finds that, the step stops.
+std::vector<int> bidirectionalSolver::solve(const octaState& s)
+{
+	std::vector<uint64_t> frontier[2];
+	std::vector<std::vector<uint64_t>> next[2];
+	std::vector<std::thread> pool;
+	std::vector<int> path, other;
+	std::mutex meetLock;
+	std::atomic<uint64_t> cursor;
+	std::atomic<bool> stop;
+	octaState solved, meetParent;
+	uint64_t key[4], i, limit = capacity / 8 * 7;
+	int t, side, depth = 0, best, meetMove = 0, meetSide = 0;
+	std::atomic<bool> full(false);
+	bool fresh;
+	if (!stabilizerChain().contains(s))
+		throw std::invalid_argument("state is not reachable");
+	if (s.solved())
+		return path;
+	for (i = 0; i < 4 * capacity; ++i)
+		table[i].store(0, std::memory_order_relaxed);
+	used = 0;
+	pack(s, key);
+	frontier[0].assign(1, insert(key, meta(0, 0, rootMove), fresh));
+	pack(solved, key);
+	frontier[1].assign(1, insert(key, meta(1, 0, rootMove), fresh));
+	best = -1;
+
+	auto work = [&](int id)
+	{
+		uint64_t begin, end, x, j, w, child[4], own[4];
+		octaState a, b;
+		size_t n0 = frontier[0].size(), n = n0 + frontier[1].size();
+		int m, sd, last, d;
+		bool isNew;
+		while (!stop && (begin = cursor.fetch_add(chunkSize)) < n)
+		{
+			end = std::min<uint64_t>(begin + chunkSize, n);
+			for (x = begin; x < end && !stop; ++x)
+			{
+				sd = x < n0 ? 0 : 1;
+				j = sd ? frontier[1][x - n0] : frontier[0][x];
+				w = table[4 * j].load(std::memory_order_acquire);
+				own[0] = w & keyMask;
+				own[1] = table[4 * j + 1].load(std::memory_order_relaxed);
+				own[2] = table[4 * j + 2].load(std::memory_order_relaxed);
+				own[3] = table[4 * j + 3].load(std::memory_order_relaxed);
+				unpack(own, a);
+				last = moveOf(w);
+				for (m = 0; m < moveCount; ++m)
+				{
+					if (m == (last ^ 1))
+						continue;
+					applyMove(a, m, b);
+					pack(b, child);
+					j = insert(child, meta(sd, depth + 1, m), isNew);
+					if (j == capacity)
+					{
+						full = true;
+						stop = true;
+						break;
+					}
+					if (isNew)
+					{
+						next[sd][id].push_back(j);
+						if (used.load(std::memory_order_relaxed) > limit)
+						{
+							full = true;
+							stop = true;
+						}
+						continue;
+					}
+					w = table[4 * j].load(std::memory_order_acquire);
+					if (sideOf(w) == sd)
+						continue;
+					d = depth + 1 + depthOf(w);
+					std::lock_guard<std::mutex> hold(meetLock);
+					if (best < 0 || d < best)
+					{
+						best = d;
+						meetParent = a;
+						meetMove = m;
+						meetSide = sd;
+						if (d == 2 * depth + 1)
+							stop = true;
+					}
+				}
+			}
+		}
+	};
+
+	while (best < 0)
+	{
+		if (frontier[0].empty() && frontier[1].empty())
+			throw std::runtime_error("the two sides never met");
+		for (side = 0; side < 2; ++side)
+			next[side].assign(threads, std::vector<uint64_t>());
+		cursor = 0;
+		stop = false;
+		for (t = 1; t < threads; ++t)
+			pool.push_back(std::thread(work, t));
+		work(0);
+		for (t = 0; t < (int)pool.size(); ++t)
+			pool[t].join();
+		pool.clear();
+		// A step cut short by a full table may have missed a shorter meeting.
+		if (full)
+			throw std::runtime_error("hash table full before the two sides met");
+		for (side = 0; side < 2; ++side)
+		{
+			frontier[side].clear();
+			for (t = 0; t < threads; ++t)
+				frontier[side].insert(frontier[side].end(), next[side][t].begin(), next[side][t].end());
+		}
+		++depth;
+	}
+	// The meeting state is stored for the other side; the side that found it
+	// reaches it through meetParent.
+	path = trace(meetParent);
+	path.push_back(meetMove);
+	applyMove(meetParent, meetMove);
+	other = trace(meetParent);
+	if (meetSide == 1)
+		path.swap(other);
+	other = invertMoves(other);
+	path.insert(path.end(), other.begin(), other.end());
+	if ((int)path.size() != best)
+		throw std::logic_error("bidirectional path has the wrong length");
+	return path;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "moves.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Optimal solver meeting in the middle: breadth-first levels grow from the
+// scramble and from solved at the same time, and a state reached from both
+// sides joins a shortest solution. It needs no pruning tables, so it is exact
+// where they are weak, but every state within about half the solution length
+// of either end is kept, which bounds the depth it can reach.
+//
+// Both sides share one lock-free open-addressed hash table keyed by the
+// packed state: 210 bits of piece indices and orientation digits spread over
+// four words, with the top 14 bits of the first word saying which side
+// reached the state, at what depth and by which move. A thread claims an
+// empty slot by swapping a busy mark into its first word, writes the other
+// three, then publishes the first; a reader that meets a busy mark waits.
+class bidirectionalSolver
+{
+private:
+	uint64_t capacity;
+	int threads;
+	std::unique_ptr<std::atomic<uint64_t>[]> table;
+	std::atomic<uint64_t> used;
+	int offset[42];
+	int pieceBits[42];
+	int width[42];
+	void pack(const octaState& s, uint64_t* key) const;
+	void unpack(const uint64_t* key, octaState& s) const;
+	uint64_t insert(const uint64_t* key, uint64_t meta, bool& fresh);
+	uint64_t find(const octaState& s) const;
+	std::vector<int> trace(octaState s) const;
+public:
+	// threads == 0 uses every core; capacity is the number of slots, a power
+	// of two, 32 bytes each.
+	explicit bidirectionalSolver(int threads = 0, uint64_t capacity = 1 << 23);
+	// Throws std::runtime_error when the table fills before the sides meet.
+	std::vector<int> solve(const octaState& s);
+};
@@ -0,0 +1,201 @@
+#include "census.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	const uint64_t chunkSize = 1 << 14;
+
+	int ones(uint64_t w)
+	{
+		w = w - (w >> 1 & 0x5555555555555555ull);
+		w = (w & 0x3333333333333333ull) + (w >> 2 & 0x3333333333333333ull);
+		w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		return (int)(w * 0x0101010101010101ull >> 56);
+	}
+	void writeBits(const std::string& path, const std::vector<uint64_t>& bits)
+	{
+		std::ofstream out(path, std::ios::binary);
+		out.write((const char*)bits.data(), bits.size() * sizeof(uint64_t));
+		if (!out)
+			throw std::runtime_error("cannot write " + path);
+	}
+	void readBits(const std::string& path, std::vector<uint64_t>& bits)
+	{
+		std::ifstream in(path, std::ios::binary);
+		in.read((char*)bits.data(), bits.size() * sizeof(uint64_t));
+		if (!in)
+			throw std::runtime_error("cannot read " + path);
+	}
+}
+
+stateCensus::stateCensus(const patternCoord& c, uint64_t moveMask, int threads)
+	: coord(c), threads(threads)
+{
+	int m;
+	for (m = 0; m < moveCount; ++m)
+		if ((moveMask >> m & 1) && coord.touches(m))
+			active.push_back(m);
+	if (this->threads <= 0)
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+	shardSize = std::max<uint64_t>(64, (coord.size() + 63) & ~63ull);
+}
+void stateCensus::useShards(uint64_t size, const std::string& dir)
+{
+	shardSize = std::max<uint64_t>(64, (size + 63) & ~63ull);
+	this->dir = dir;
+}
+std::string stateCensus::shardPath(const char* kind, uint64_t i) const
+{
+	return dir + "census-" + kind + "-" + std::to_string(i) + ".bin";
+}
+
+std::vector<uint64_t> stateCensus::run()
+{
+	uint64_t n = coord.size(), shards = shardCount(), words = shardSize / 64;
+	uint64_t i, t, src, solved, total, reached = 1;
+	std::vector<uint64_t> seen(words), front(words), fresh(words), histogram;
+	std::vector<uint64_t> frontCount(shards, 0), nextCount(shards, 0);
+	std::unique_ptr<std::atomic<uint64_t>[]> next(new std::atomic<uint64_t>[words]);
+	std::vector<std::thread> pool;
+	octaState s;
+	int k;
+	bool paged = shards > 1, pull;
+
+	// Sets every unseen neighbour of the frontier shard src that falls in
+	// shard t. Without shards, a frontier larger than what is left is pulled
+	// instead: each unseen index looks for a neighbour on it.
+	auto expand = [&](uint64_t src, uint64_t t, bool pull)
+	{
+		std::atomic<uint64_t> cursor(0);
+		uint64_t base = src * shardSize, low = t * shardSize;
+		uint64_t end = std::min(shardSize, n - base);
+		auto work = [&]()
+		{
+			octaState a, b;
+			uint64_t begin, stop, x, j;
+			size_t m;
+			while ((begin = cursor.fetch_add(chunkSize)) < end)
+			{
+				stop = std::min(begin + chunkSize, end);
+				for (x = begin; x < stop; ++x)
+				{
+					if (pull)
+					{
+						if (seen[x >> 6] >> (x & 63) & 1)
+							continue;
+						coord.unrank(x, a);
+						for (m = 0; m < active.size(); ++m)
+						{
+							applyMove(a, active[m], b);
+							j = coord.rank(b);
+							if (front[j >> 6] >> (j & 63) & 1)
+							{
+								next[x >> 6].fetch_or(1ull << (x & 63), std::memory_order_relaxed);
+								break;
+							}
+						}
+						continue;
+					}
+					if (!(front[x >> 6] >> (x & 63)))
+					{
+						x |= 63;
+						continue;
+					}
+					if (!(front[x >> 6] >> (x & 63) & 1))
+						continue;
+					coord.unrank(base + x, a);
+					for (m = 0; m < active.size(); ++m)
+					{
+						applyMove(a, active[m], b);
+						j = coord.rank(b) - low;
+						if (j < shardSize && !(seen[j >> 6] >> (j & 63) & 1))
+							next[j >> 6].fetch_or(1ull << (j & 63), std::memory_order_relaxed);
+					}
+				}
+			}
+		};
+		for (k = 1; k < threads; ++k)
+			pool.push_back(std::thread(work));
+		work();
+		for (k = 0; k < (int)pool.size(); ++k)
+			pool[k].join();
+		pool.clear();
+	};
+
+	solved = coord.rank(s);
+	for (t = 0; t < shards; ++t)
+	{
+		std::fill(seen.begin(), seen.end(), 0);
+		if (solved / shardSize == t)
+			seen[solved % shardSize >> 6] |= 1ull << (solved & 63);
+		if (paged)
+		{
+			writeBits(shardPath("seen", t), seen);
+			writeBits(shardPath("front", t), seen);
+		}
+	}
+	front = seen;
+	frontCount[solved / shardSize] = 1;
+	histogram.push_back(1);
+	for (;;)
+	{
+		pull = !paged && histogram.back() > n - reached;
+		total = 0;
+		for (t = 0; t < shards; ++t)
+		{
+			if (paged)
+				readBits(shardPath("seen", t), seen);
+			for (i = 0; i < words; ++i)
+				next[i].store(0, std::memory_order_relaxed);
+			for (src = 0; src < shards; ++src)
+				if (frontCount[src])
+				{
+					if (paged)
+						readBits(shardPath("front", src), front);
+					expand(src, t, pull);
+				}
+			nextCount[t] = 0;
+			for (i = 0; i < words; ++i)
+			{
+				fresh[i] = next[i].load(std::memory_order_relaxed);
+				seen[i] |= fresh[i];
+				nextCount[t] += ones(fresh[i]);
+			}
+			total += nextCount[t];
+			if (paged)
+			{
+				writeBits(shardPath("seen", t), seen);
+				writeBits(shardPath("next", t), fresh);
+			}
+		}
+		if (total == 0)
+			break;
+		histogram.push_back(total);
+		reached += total;
+		frontCount = nextCount;
+		if (paged)
+			for (t = 0; t < shards; ++t)
+			{
+				std::remove(shardPath("front", t).c_str());
+				if (std::rename(shardPath("next", t).c_str(), shardPath("front", t).c_str()))
+					throw std::runtime_error("cannot rename " + shardPath("next", t));
+			}
+		else
+			front.swap(fresh);
+	}
+	if (paged)
+		for (t = 0; t < shards; ++t)
+		{
+			std::remove(shardPath("seen", t).c_str());
+			std::remove(shardPath("front", t).c_str());
+			std::remove(shardPath("next", t).c_str());
+		}
+	return histogram;
+}
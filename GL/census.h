@@ -0,0 +1,39 @@
+#pragma once
+#include "moves.h"
+#include "orbit.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Breadth-first enumeration of every index of a pattern coordinate under a
+// move set, counting how many sit at each distance from solved. Only one bit
+// per index is kept for each of the seen, frontier and next sets.
+//
+// The index space can be cut into shards. A level is then built one target
+// shard at a time: the whole frontier is streamed past it shard by shard and
+// only the neighbours landing inside it are kept, so memory holds four
+// shard-sized sets (seen, frontier, next and the fresh copy of next) while
+// the rest live in files.
+class stateCensus
+{
+private:
+	patternCoord coord;
+	std::vector<int> active;
+	int threads;
+	uint64_t shardSize;
+	std::string dir;
+	uint64_t shardCount() const
+	{
+		return (coord.size() + shardSize - 1) / shardSize;
+	}
+	std::string shardPath(const char* kind, uint64_t i) const;
+public:
+	// threads == 0 uses every core.
+	explicit stateCensus(const patternCoord& c, uint64_t moveMask = allMoves, int threads = 0);
+	// Keeps at most size indices (a multiple of 64) in memory per set; the
+	// other shards go to files in dir.
+	void useShards(uint64_t size, const std::string& dir);
+	// Number of indices at each distance; the last entry is the deepest level.
+	std::vector<uint64_t> run();
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Lock-free ring for one producer thread and one consumer thread. Each index
+// is written by one side only, and the release store that advances it
+// publishes the item it covers.
+template <class T, size_t N>
+class spscRing
+{
+private:
+	static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+	T item[N];
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+public:
+	spscRing()
+		: head(0), tail(0)
+	{
+	}
+	// Producer side; false when the ring is full.
+	bool push(const T& v)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == N)
+			return false;
+		item[t & (N - 1)] = v;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+	// Consumer side; false when the ring is empty.
+	bool pop(T& v)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+		v = item[h & (N - 1)];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+// Latest-value handoff from one writer thread to one reader thread. The
+// writer fills its back slot and swaps it with the middle one; the reader
+// swaps its front slot with the middle one when that holds something new.
+// Neither side ever waits, and the reader always sees a whole snapshot.
+template <class T>
+class tripleBuffer
+{
+private:
+	static const int fresh = 4;
+	T slot[3];
+	std::atomic<int> middle;
+	int back;
+	int front;
+public:
+	tripleBuffer()
+		: middle(1), back(0), front(2)
+	{
+	}
+	T& writeSlot()
+	{
+		return slot[back];
+	}
+	void publish()
+	{
+		back = middle.exchange(back | fresh, std::memory_order_acq_rel) & 3;
+	}
+	const T& read()
+	{
+		if (middle.load(std::memory_order_relaxed) & fresh)
+			front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+		return slot[front];
+	}
+};
@@ -0,0 +1,108 @@
+#include "finder.h"
+#include "automaton.h"
+#include "optimizer.h"
+#include "orbit.h"
+
+#include <stdexcept>
+
+algorithmFinder::algorithmFinder(int depth)
+	: near(depth), bestLength(0)
+{
+}
+
+void algorithmFinder::search(const octaState& s, int node, int g, int bound)
+{
+	const moveAutomaton& canon = moveAutomaton::get();
+	octaState t;
+	int m, after, d;
+	if (g == bound)
+	{
+		if ((d = near.lookup(s, bestLength - g, found)) >= 0)
+		{
+			bestLength = d + g;
+			best = found;
+			best.insert(best.end(), path.rbegin(), path.rend());
+			for (m = d; m < bestLength; ++m)
+				best[m] ^= 1;
+		}
+		return;
+	}
+	for (m = 0; m < moveCount; ++m)
+		if ((after = canon.next(node, m)) >= 0)
+		{
+			applyMove(s, m, t);
+			path.push_back(m);
+			search(t, after, g + 1, bound);
+			path.pop_back();
+		}
+}
+// The walk from a target t applies some sequence p; a nearby state reached by
+// q then gives q followed by the inverse of p.
+std::vector<int> algorithmFinder::find(const std::vector<octaState>& targets, int maxLength)
+{
+	size_t i;
+	int bound;
+	best.clear();
+	bestLength = maxLength + 1;
+	for (bound = 0; bound <= maxLength - near.getDepth() || bound == 0; ++bound)
+	{
+		for (i = 0; i < targets.size(); ++i)
+			search(targets[i], moveAutomaton::start, 0, bound);
+		if (bestLength <= maxLength)
+			break;
+	}
+	return mergeMoves(best);
+}
+
+std::vector<octaState> cycleTargets(const std::vector<std::vector<int>>& cycles, bool anyTwist)
+{
+	const orbitTable& orbits = orbitTable::get();
+	std::vector<octaState> targets;
+	std::vector<int> moved;
+	octaState s;
+	uint64_t total = 1, code, r;
+	size_t c, k, i;
+	int x, y, o, d, twists, sum[8];
+	bool used[42] = {};
+	bool valid;
+	for (c = 0; c < cycles.size(); ++c)
+		for (k = 0; k < cycles[c].size(); ++k)
+		{
+			x = cycles[c][k];
+			y = cycles[c][(k + 1) % cycles[c].size()];
+			if (x < 0 || x >= 42 || y < 0 || y >= 42 || used[x])
+				throw std::invalid_argument("cycle slots must be distinct and in [0, 42)");
+			if (orbits.orbitOfSlot(x) != orbits.orbitOfSlot(y))
+				throw std::invalid_argument("a cycle must stay within one orbit");
+			used[x] = true;
+			s.pos[y] = (unsigned char)x;
+			moved.push_back(y);
+			if (anyTwist)
+				total *= orbits.orbit(orbits.orbitOfSlot(y)).twists;
+		}
+	for (code = 0; code < total; ++code)
+	{
+		for (o = 0; o < orbits.orbits(); ++o)
+			sum[o] = 0;
+		for (i = 0, r = code; i < moved.size(); ++i)
+		{
+			y = moved[i];
+			o = orbits.orbitOfSlot(y);
+			twists = orbits.orbit(o).twists;
+			d = 0;
+			if (anyTwist)
+			{
+				d = (int)(r % twists);
+				r /= twists;
+			}
+			s.ori[y] = (unsigned char)orbits.rotation(y, s.pos[y], d);
+			sum[o] += d;
+		}
+		valid = true;
+		for (o = 0; o < orbits.orbits(); ++o)
+			valid &= !orbits.orbit(o).twistSum || sum[o] % orbits.orbit(o).twists == 0;
+		if (valid && !s.solved())
+			targets.push_back(s);
+	}
+	return targets;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "nearby.h"
+
+#include <vector>
+
+// Meet-in-the-middle search for short sequences reaching a chosen state, such
+// as a 3-cycle of a few pieces with everything else fixed. One half is the
+// table of states near solved; from each target, canonical sequences of
+// growing length are walked and every state they reach is looked up there.
+// Every sequence of length L is seen once the walk is L - depth deep, so the
+// first walk depth with a hit gives the shortest.
+class algorithmFinder
+{
+private:
+	nearbyStates near;
+	std::vector<int> path, best, found;
+	int bestLength;
+	void search(const octaState& s, int node, int g, int bound);
+public:
+	explicit algorithmFinder(int depth = 4);
+	// A shortest sequence taking solved to any of targets, or empty when none
+	// has at most maxLength moves.
+	std::vector<int> find(const std::vector<octaState>& targets, int maxLength);
+};
+
+// Targets carrying the piece at c[k] of each cycle to c[k + 1] with every
+// other piece solved. With anyTwist the moved pieces may come out in any
+// orientation their orbit's twist sum allows, and a one-slot cycle twists a
+// piece in place. The solved state is never a target.
+std::vector<octaState> cycleTargets(const std::vector<std::vector<int>>& cycles, bool anyTwist);
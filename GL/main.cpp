@@ -5,13 +5,25 @@
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <fstream>
-#include <queue>
+#include <deque>
+#include <mutex>
 #include <vector>
 #include <utility>
 #include <string>
 #include <sstream>
+#include <thread>
+
+#include "channel.h"
+#include "rotation.h"
+#include "octaState.h"
+#include "moves.h"
+#include "optimizer.h"
+#include "tools.h"
 
 
 class Shader
@@ -90,65 +102,168 @@ private:
 		}
 	}
 };
+typedef std::chrono::steady_clock animClock;
+// Easing curves map the elapsed fraction of a turn to the fraction of its
+// angle shown.
+float easeLinear(float t)
+{
+	return t;
+}
+float easeInOut(float t)
+{
+	return t * t * (3 - 2 * t);
+}
+// A queued turn, or a reset when q is -1. Started turns have a start time and
+// a length.
+struct turnTask
+{
+	int q;
+	int shift;
+	bool started;
+	animClock::time_point start = animClock::time_point();
+	animClock::duration length = animClock::duration::zero();
+};
+// Turns are timed on a monotonic clock: each frame shows the angle the elapsed
+// time calls for, so a turn takes the same time at any refresh rate and a late
+// frame only skips ahead.
+//
+// Turns whose pieces are disjoint commute, so a queued turn starts as soon as
+// it shares no slot with a running turn or with an earlier queued one; a reset
+// waits for everything before it. Each slot holds the rotation of the one
+// running turn that carries it.
+//
+// A backlog is kept short three ways: turns not yet started are coalesced as
+// they are queued, a turn runs faster the more are waiting, and past skipDepth
+// waiting turns are applied without animation.
 class octahedron
 {
 private:
 	std::pair<int, int> line[42];
-	int block[42];
-	std::queue<std::pair<std::pair<int, int>, int > > taskQ;
-	glm::mat4 spinRot[42];
-	glm::mat4 temp;
-	std::vector< std::vector<int> > face[8];
-	std::vector< std::vector<int> > corner[13];
+	octaState state;
+	std::deque<turnTask> taskQ;
+	bool turning[42];
+	glm::mat4 pending[42];
+	double turnSeconds;
+	float (*easing)(float);
+	size_t skipDepth;
+	static bool touches(const turnTask& t, int i)
+	{
+		int m = moveIndex(t.q, t.shift);
+		return moves.turn[m][i] != 0 || moves.perm[m][i] != i;
+	}
+	void startTurns(animClock::time_point at);
+	void finish(size_t k);
 public:
 	octahedron();
+	// The setters and everything below are for the simulation thread only.
+	void setTurnTime(double seconds)
+	{
+		turnSeconds = seconds;
+	}
+	void setEasing(float (*curve)(float))
+	{
+		easing = curve;
+	}
+	// 0 always animates.
+	void setSkipDepth(size_t depth)
+	{
+		skipDepth = depth;
+	}
 	glm::mat4 getSpinRot(int i)
 	{
-		return spinRot[i];
+		if (turning[i])
+			return pending[i] * rotationGroup::get().matrix(state.ori[i]);
+		return rotationGroup::get().matrix(state.ori[i]);
 	}
 	std::pair<int, int> getPair(int i)
 	{
-		return line[i];
+		return line[state.pos[i]];
 	}
-	void addTask(int i, int j)
+	const octaState& getState()
 	{
-		taskQ.push({ { i,j },0 });
+		return state;
 	}
+	bool busy() const
+	{
+		return !taskQ.empty();
+	}
+	void addTask(int i, int j);
 	void task();
-	void spinFace(int);
-	void spinFace2(std::vector<int>);
-	void spinCorner(int);
-	void spinCorner2(std::vector<int>);
-}cube;
-octahedron::octahedron()
+};
+
+// The puzzle runs on its own thread. Key presses reach it through inputs, and
+// after every step it publishes what the renderer draws through frames, so
+// neither thread ever waits on the other's work. It sleeps until a key is
+// pressed or, while turns run, the renderer asks for the next frame; the lock
+// only guards those two flags.
+struct frameSnapshot
 {
+	glm::mat4 spin[42];
+	std::pair<int, int> draw[42];
+};
+octahedron cube;
+spscRing<std::pair<int, int>, 256> inputs;
+tripleBuffer<frameSnapshot> frames;
+// Inputs are turns and resets for addTask, or settings: these carry a kind
+// below -1 and the new value.
+const int turnTimeInput = -2, easingInput = -3;
+std::atomic<bool> simulating(true);
+std::mutex wakeLock;
+std::condition_variable wake;
+bool inputWaiting = false, frameWanted = false;
+
+void publishFrame()
+{
+	frameSnapshot& f = frames.writeSlot();
 	int i;
 	for (i = 0; i < 42; ++i)
 	{
-		block[i] = i;
-		spinRot[i] = glm::mat4(1.0f);
+		f.spin[i] = cube.getSpinRot(i);
+		f.draw[i] = cube.getPair(i);
 	}
-	face[0] = { { 0, 17, 19}, {1, 9, 10}, {5, 18, 6} , {4, 25, 11}, {16, 26, 2} };
-	face[1] = { { 0, 19, 21}, {2, 11, 12}, {6, 20, 7} , {1, 27, 13}, {10, 28, 3} };
-	face[2] = { { 0, 21, 23}, {3, 13, 14}, {7, 22, 8} , {2, 29, 15}, {12, 30, 4} };
-	face[3] = { { 0, 23, 17}, {4, 15, 16}, {8, 24, 5} , {3, 31, 9}, {14, 32, 1} };
-	face[4] = { { 41, 19, 17}, {37, 26, 25}, {34, 18, 33} , {38, 10, 32}, {27, 9, 40} };
-	face[5] = { { 41, 21, 19}, {38, 28, 27}, {35, 20, 34} , {39, 12, 26}, {29, 11, 37} };
-	face[6] = { { 41, 23, 21}, {39, 30, 29}, {36, 22, 35} , {40, 14, 28}, {31, 13, 38} };
-	face[7] = { { 41, 17, 23}, {40, 32, 31}, {33, 24, 36} , {37, 16, 30}, {25, 15, 39} };
-	corner[0] = { {0} };
-	corner[1] = { {1,2,3,4}, {5,6,7,8} ,{0} };
-	corner[2] = { {17} };
-	corner[3] = { {9,16,32,25}, {18,5,24,33} ,{17} };
-	corner[4] = { {19} };
-	corner[5] = { {11,10,26,27}, {6,18,34,20} ,{19} };
-	corner[6] = { {21} };
-	corner[7] = { {13,12,28,29}, {22,7,20,35} ,{21} };
-	corner[8] = { {23} };
-	corner[9] = { {15,14,30,31}, {8,22,36,24} ,{23} };
-	corner[10] = { {41} };
-	corner[11] = { {40,39,38,37} ,{36,35,34,33},{41} };
-
+	frames.publish();
+}
+void simulate()
+{
+	std::pair<int, int> input;
+	std::unique_lock<std::mutex> hold(wakeLock);
+	while (simulating.load(std::memory_order_relaxed))
+	{
+		inputWaiting = frameWanted = false;
+		hold.unlock();
+		while (inputs.pop(input))
+			if (input.first == turnTimeInput)
+				cube.setTurnTime(input.second / 1000.0);
+			else if (input.first == easingInput)
+				cube.setEasing(input.second ? easeLinear : easeInOut);
+			else
+				cube.addTask(input.first, input.second);
+		cube.task();
+		publishFrame();
+		hold.lock();
+		wake.wait(hold, [] { return inputWaiting || (frameWanted && cube.busy()) || !simulating.load(std::memory_order_relaxed); });
+	}
+}
+void wakeSimulation(bool& reason)
+{
+	std::lock_guard<std::mutex> hold(wakeLock);
+	reason = true;
+	wake.notify_one();
+}
+// Every push wakes the simulation, so a full ring only holds the input thread
+// briefly.
+void queueInput(int i, int j)
+{
+	while (!inputs.push({ i, j }))
+		std::this_thread::yield();
+	wakeSimulation(inputWaiting);
+}
+octahedron::octahedron()
+	: turnSeconds(0.1), easing(easeInOut), skipDepth(32)
+{
+	int i;
+	for (i = 0; i < 42; ++i)
+		turning[i] = false;
 	line[0] = { 0, 12 };
 	line[1] = { 12, 3 };
 	line[2] = { 15, 3 };
@@ -192,181 +307,126 @@ octahedron::octahedron()
 	line[40] = { 201, 3 };
 	line[41] = { 204, 12 };
 }
-void octahedron::task()
+// The turns queued since the last started one or reset are merged with the
+// new one the way mergeMoves does: inverse pairs cancel and repeated turns
+// about one axis add up.
+void octahedron::addTask(int i, int j)
 {
-	int i, q, shift;
-	if (!taskQ.empty())
+	std::vector<int> seq;
+	size_t begin = taskQ.size(), k;
+	if (i < 0)
 	{
-		q = taskQ.front().first.first;
-		shift = taskQ.front().first.second;
-		if (q == -1 && shift == -1)
-		{
-			for (i = 0; i < 42; ++i)
-			{
-				block[i] = i;
-				spinRot[i] = glm::mat4(1.0f);
-			}
-			taskQ.pop();
-			return;
-		}
-		if (taskQ.front().second == 4)
+		taskQ.push_back({ i, j, false });
+		return;
+	}
+	while (begin > 0 && !taskQ[begin - 1].started && taskQ[begin - 1].q > 0)
+		--begin;
+	for (k = begin; k < taskQ.size(); ++k)
+		seq.push_back(moveIndex(taskQ[k].q, taskQ[k].shift));
+	seq.push_back(moveIndex(i, j));
+	seq = mergeMoves(seq);
+	taskQ.erase(taskQ.begin() + begin, taskQ.end());
+	for (k = 0; k < seq.size(); ++k)
+		taskQ.push_back({ moveId(seq[k]), moveShift(seq[k]), false });
+}
+// Starts every queued turn that is free at time at. A turn takes turnSeconds
+// divided by the number queued, so a backlog of n drains in about
+// turnSeconds * ln n.
+void octahedron::startTurns(animClock::time_point at)
+{
+	bool busy[42] = {}, free;
+	size_t k = 0;
+	int i;
+	while (k < taskQ.size())
+	{
+		turnTask& t = taskQ[k];
+		if (t.q < 0)
 		{
-			if (q <= 8)
-			{
-				if (shift < 0)
-					spinFace(q - 1);
-				spinFace(q - 1);
-			}
-			else if (q % 2 == 0)
-			{
-				if (shift < 0)
-				{
-					spinCorner(q - 9);
-					spinCorner(q - 9);
-				}
-				spinCorner(q - 9);
-			}
-			taskQ.pop();
-			return;
+			if (k > 0)
+				return;
+			state.reset();
+			taskQ.pop_front();
+			continue;
 		}
-		switch (q)
+		free = !t.started;
+		for (i = 0; i < 42 && free; ++i)
+			free = !(busy[i] && touches(t, i));
+		if (free)
 		{
-		case 1:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(1.0f, 1.0f, 1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[0][i / 3][i % 3]]] = temp * spinRot[block[face[0][i / 3][i % 3]]];
-			break;
-		case 2:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(1.0f, -1.0f, 1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[1][i / 3][i % 3]]] = temp * spinRot[block[face[1][i / 3][i % 3]]];
-			break;
-		case 3:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(-1.0f, -1.0f, 1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[2][i / 3][i % 3]]] = temp * spinRot[block[face[2][i / 3][i % 3]]];
-			break;
-		case 4:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(-1.0f, 1.0f, 1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[3][i / 3][i % 3]]] = temp * spinRot[block[face[3][i / 3][i % 3]]];
-			break;
-		case 5:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(1.0f, 1.0f, -1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[4][i / 3][i % 3]]] = temp * spinRot[block[face[4][i / 3][i % 3]]];
-			break;
-		case 6:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(1.0f, -1.0f, -1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[5][i / 3][i % 3]]] = temp * spinRot[block[face[5][i / 3][i % 3]]];
-			break;
-		case 7:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(-1.0f, -1.0f, -1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[6][i / 3][i % 3]]] = temp * spinRot[block[face[6][i / 3][i % 3]]];
-			break;
-		case 8:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 6 * shift, glm::normalize(glm::vec3(-1.0f, 1.0f, -1.0f)));
-			for (i = 0; i < 15; ++i)
-				spinRot[block[face[7][i / 3][i % 3]]] = temp * spinRot[block[face[7][i / 3][i % 3]]];
-			break;
-		case 9:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, 0.0f, 1.0f)));
-			spinRot[block[corner[0][0][0]]] = temp * spinRot[block[corner[0][0][0]]];
-			break;
-		case 10:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, 0.0f, 1.0f)));
-			for (i = 0; i < 9; ++i)
-				spinRot[block[corner[1][i / 4][i % 4]]] = temp * spinRot[block[corner[1][i / 4][i % 4]]];
-			break;
-		case 11:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, 1.0f, 0.0f)));
-			spinRot[block[corner[2][0][0]]] = temp * spinRot[block[corner[2][0][0]]];
-			break;
-		case 12:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, 1.0f, 0.0f)));
-			for (i = 0; i < 9; ++i)
-				spinRot[block[corner[3][i / 4][i % 4]]] = temp * spinRot[block[corner[3][i / 4][i % 4]]];
-			break;
-		case 13:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(1.0f, 0.0f, 0.0f)));
-			spinRot[block[corner[4][0][0]]] = temp * spinRot[block[corner[4][0][0]]];
-			break;
-		case 14:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(1.0f, 0.0f, 0.0f)));
-			for (i = 0; i < 9; ++i)
-				spinRot[block[corner[5][i / 4][i % 4]]] = temp * spinRot[block[corner[5][i / 4][i % 4]]];
-			break;
-		case 15:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, -1.0f, 0.0f)));
-			spinRot[block[corner[6][0][0]]] = temp * spinRot[block[corner[6][0][0]]];
-			break;
-		case 16:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, -1.0f, 0.0f)));
-			for (i = 0; i < 9; ++i)
-				spinRot[block[corner[7][i / 4][i % 4]]] = temp * spinRot[block[corner[7][i / 4][i % 4]]];
-			break;
-		case 17:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(-1.0f, 0.0f, 0.0f)));
-			spinRot[block[corner[8][0][0]]] = temp * spinRot[block[corner[8][0][0]]];
-			break;
-		case 18:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(-1.0f, 0.0f, 0.0f)));
-			for (i = 0; i < 9; ++i)
-				spinRot[block[corner[9][i / 4][i % 4]]] = temp * spinRot[block[corner[9][i / 4][i % 4]]];
-			break;
-		case 19:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f)));
-			spinRot[block[corner[10][0][0]]] = temp * spinRot[block[corner[10][0][0]]];
-			break;
-		case 20:
-			temp = glm::rotate(glm::mat4(1.0f), glm::pi<float>() / 8 * shift, glm::normalize(glm::vec3(0.0f, 0.0f, -1.0f)));
-			for (i = 0; i < 9; ++i)
-				spinRot[block[corner[11][i / 4][i % 4]]] = temp * spinRot[block[corner[11][i / 4][i % 4]]];
-			break;
+			t.started = true;
+			t.start = at;
+			t.length = std::chrono::duration_cast<animClock::duration>(std::chrono::duration<double>(turnSeconds / taskQ.size()));
 		}
-		++taskQ.front().second;
+		for (i = 0; i < 42; ++i)
+			busy[i] |= touches(t, i);
+		++k;
 	}
 }
-void octahedron::spinFace(int n)
-{
-	spinFace2(face[n][0]);
-	spinFace2(face[n][1]);
-	spinFace2(face[n][2]);
-	spinFace2(face[n][3]);
-	spinFace2(face[n][4]);
-}
-void octahedron::spinFace2(std::vector<int> a)
+// Turns that run together are disjoint, so a finished one is applied without
+// disturbing the rest.
+void octahedron::finish(size_t k)
 {
-	int temp;
-	temp = block[a[0]];
-	block[a[0]] = block[a[1]];
-	block[a[1]] = block[a[2]];
-	block[a[2]] = temp;
+	if (taskQ[k].q < 0)
+		state.reset();
+	else
+		applyMove(state, moveIndex(taskQ[k].q, taskQ[k].shift));
+	taskQ.erase(taskQ.begin() + k);
 }
-void octahedron::spinCorner(int n)
-{
-	spinCorner2(corner[n][0]);
-	spinCorner2(corner[n][1]);
-}
-void octahedron::spinCorner2(std::vector<int> a)
+// Finished turns are applied in the order they end; each may free queued
+// turns, which start the moment it ended, so any number of them can finish
+// in one late frame.
+void octahedron::task()
 {
-	int temp;
-	temp = block[a[0]];
-	block[a[0]] = block[a[1]];
-	block[a[1]] = block[a[2]];
-	block[a[2]] = block[a[3]];
-	block[a[3]] = temp;
+	animClock::time_point now = animClock::now(), end;
+	glm::mat4 spin;
+	float t, angle;
+	size_t k, first;
+	int i, m, q;
+	while (skipDepth > 0 && taskQ.size() > skipDepth)
+		finish(0);
+	startTurns(now);
+	for (;;)
+	{
+		first = taskQ.size();
+		for (k = 0; k < taskQ.size(); ++k)
+			if (taskQ[k].started && (first == taskQ.size() || taskQ[k].start + taskQ[k].length < end))
+			{
+				first = k;
+				end = taskQ[k].start + taskQ[k].length;
+			}
+		if (first == taskQ.size() || end > now)
+			break;
+		finish(first);
+		startTurns(end);
+	}
+	for (i = 0; i < 42; ++i)
+		turning[i] = false;
+	for (k = 0; k < taskQ.size(); ++k)
+	{
+		if (!taskQ[k].started)
+			continue;
+		q = taskQ[k].q;
+		m = moveIndex(q, taskQ[k].shift);
+		t = (float)(std::chrono::duration<double>(now - taskQ[k].start) / taskQ[k].length);
+		angle = (q <= 8 ? glm::pi<float>() * 2 / 3 : glm::pi<float>() / 2) * taskQ[k].shift * easing(t);
+		spin = glm::rotate(glm::mat4(1.0f), angle, glm::normalize(glm::vec3(turnAxis[q - 1][0], turnAxis[q - 1][1], turnAxis[q - 1][2])));
+		for (i = 0; i < 42; ++i)
+			if (moves.turn[m][i])
+			{
+				turning[i] = true;
+				pending[i] = spin;
+			}
+	}
 }
 
-
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void init();
 
 GLint shift = 1;
+GLint turnMillis = 100;
+GLboolean linearTurns = false;
 GLboolean drag = false;
 GLdouble X = 0, Y = glm::pi<GLdouble>() * 0.5;
 GLdouble xpos1, ypos1;
@@ -975,49 +1035,55 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 	else if (key == GLFW_KEY_LEFT_SHIFT && action == GLFW_RELEASE)
 		shift = 1;
 	if (key == GLFW_KEY_Q && action == GLFW_PRESS)
-		cube.addTask(1, shift);
+		queueInput(1, shift);
 	else if (key == GLFW_KEY_E && action == GLFW_PRESS)
-		cube.addTask(2, shift);
+		queueInput(2, shift);
 	else if (key == GLFW_KEY_C && action == GLFW_PRESS)
-		cube.addTask(3, shift);
+		queueInput(3, shift);
 	else if (key == GLFW_KEY_Z && action == GLFW_PRESS)
-		cube.addTask(4, shift);
+		queueInput(4, shift);
 	else if (key == GLFW_KEY_W && action == GLFW_PRESS)
-		cube.addTask(5, shift);
+		queueInput(5, shift);
 	else if (key == GLFW_KEY_D && action == GLFW_PRESS)
-		cube.addTask(6, shift);
+		queueInput(6, shift);
 	else if (key == GLFW_KEY_X && action == GLFW_PRESS)
-		cube.addTask(7, shift);
+		queueInput(7, shift);
 	else if (key == GLFW_KEY_A && action == GLFW_PRESS)
-		cube.addTask(8, shift);
+		queueInput(8, shift);
 	else if (key == GLFW_KEY_T && action == GLFW_PRESS)
-		cube.addTask(9, shift);
+		queueInput(9, shift);
 	else if (key == GLFW_KEY_Y && action == GLFW_PRESS)
-		cube.addTask(10, shift);
+		queueInput(10, shift);
 	else if (key == GLFW_KEY_G && action == GLFW_PRESS)
-		cube.addTask(11, shift);
+		queueInput(11, shift);
 	else if (key == GLFW_KEY_H && action == GLFW_PRESS)
-		cube.addTask(12, shift);
+		queueInput(12, shift);
 	else if (key == GLFW_KEY_B && action == GLFW_PRESS)
-		cube.addTask(13, shift);
+		queueInput(13, shift);
 	else if (key == GLFW_KEY_N && action == GLFW_PRESS)
-		cube.addTask(14, shift);
+		queueInput(14, shift);
 	else if (key == GLFW_KEY_I && action == GLFW_PRESS)
-		cube.addTask(15, shift);
+		queueInput(15, shift);
 	else if (key == GLFW_KEY_U && action == GLFW_PRESS)
-		cube.addTask(16, shift);
+		queueInput(16, shift);
 	else if (key == GLFW_KEY_K && action == GLFW_PRESS)
-		cube.addTask(17, shift);
+		queueInput(17, shift);
 	else if (key == GLFW_KEY_J && action == GLFW_PRESS)
-		cube.addTask(18, shift);
+		queueInput(18, shift);
 	else if (key == GLFW_KEY_COMMA && action == GLFW_PRESS)
-		cube.addTask(19, shift);
+		queueInput(19, shift);
 	else if (key == GLFW_KEY_M && action == GLFW_PRESS)
-		cube.addTask(20, shift);
+		queueInput(20, shift);
 	else if (key == GLFW_KEY_R && action == GLFW_PRESS)
-		cube.addTask(-1, -1);
+		queueInput(-1, -1);
+	else if (key == GLFW_KEY_LEFT_BRACKET && action == GLFW_PRESS && turnMillis < 1600)
+		queueInput(turnTimeInput, turnMillis *= 2);
+	else if (key == GLFW_KEY_RIGHT_BRACKET && action == GLFW_PRESS && turnMillis > 25)
+		queueInput(turnTimeInput, turnMillis /= 2);
+	else if (key == GLFW_KEY_L && action == GLFW_PRESS)
+		queueInput(easingInput, linearTurns = !linearTurns);
 	//	else if (key == GLFW_KEY_F && action == GLFW_PRESS)
-	//		cube.addTask(-1, 0);
+	//		queueInput(-1, 0);
 }
 
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
@@ -1062,9 +1128,11 @@ void init()
 
 }
 
-int main()
+int main(int argc, char* argv[])
 {
 	int i;
+	if (argc > 1)
+		return runTool(argc, argv);
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -1113,22 +1181,28 @@ int main()
 	projectionLoc = glGetUniformLocation(cubeShader.ID, "projection");
 	glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
 	glEnable(GL_DEPTH_TEST);
+	publishFrame();
+	std::thread simulation(simulate);
 	while (!glfwWindowShouldClose(window))
 	{
 		processInput(window);
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		cube.task();
+		const frameSnapshot& frame = frames.read();
 		glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		for (i = 0; i < 42; ++i)
 		{
-			glUniformMatrix4fv(spinLoc, 1, GL_FALSE, glm::value_ptr(cube.getSpinRot(i)));
-			tempPair = cube.getPair(i);
+			glUniformMatrix4fv(spinLoc, 1, GL_FALSE, glm::value_ptr(frame.spin[i]));
+			tempPair = frame.draw[i];
 			glDrawArrays(GL_TRIANGLES, tempPair.first, tempPair.second);
 		}
 		glfwSwapBuffers(window);
+		wakeSimulation(frameWanted);
 		glfwPollEvents();
 	}
+	simulating = false;
+	wakeSimulation(frameWanted);
+	simulation.join();
 
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, VBO);
@@ -0,0 +1,339 @@
+#include "moves.h"
+#include "rotation.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MOVE_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define KERNEL_TARGET(x)
+#else
+#define KERNEL_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+namespace
+{
+	// shuffle[m][k] holds the pshufb control that pulls every output byte of
+	// the 96-byte state out of source lane k (0x80 where it comes from another
+	// lane); turn[m] is 0xff on the orientation bytes the move rotates.
+	struct twistTable
+	{
+		unsigned char rot[moveCount];
+		unsigned char twist[moveCount][42];
+		alignas(32) unsigned char shuffle[moveCount][3][96];
+		alignas(32) unsigned char turn[moveCount][96];
+		alignas(32) unsigned char row[24][32];
+		twistTable()
+		{
+			const rotationGroup& g = rotationGroup::get();
+			int m, i, k, r, s;
+			for (m = 0; m < moveCount; ++m)
+			{
+				r = g.turn(turnAxis[moveId(m) - 1][0], turnAxis[moveId(m) - 1][1], turnAxis[moveId(m) - 1][2]);
+				rot[m] = m % 2 ? g.inv(r) : r;
+				for (i = 0; i < 42; ++i)
+					twist[m][i] = moves.turn[m][i] ? rot[m] : 0;
+				for (i = 0; i < 96; ++i)
+				{
+					s = i % 48 < 42 ? moves.perm[m][i % 48] : i % 48;
+					for (k = 0; k < 3; ++k)
+						shuffle[m][k][i] = s / 16 == k ? s % 16 : 0x80;
+					turn[m][i] = i >= 48 && i < 90 && moves.turn[m][i - 48] ? 0xff : 0;
+				}
+			}
+			for (r = 0; r < 24; ++r)
+				for (i = 0; i < 32; ++i)
+					row[r][i] = i < 24 ? g.mul(r, i) : 0;
+		}
+	};
+	const twistTable& twists()
+	{
+		static const twistTable t;
+		return t;
+	}
+
+	void applyScalar(const twistTable& tw, const octaState& a, int m, octaState& b)
+	{
+		const rotationGroup& g = rotationGroup::get();
+		const unsigned char* p = moves.perm[m];
+		const unsigned char* t = tw.twist[m];
+		int i;
+		for (i = 0; i < 42; ++i)
+		{
+			b.pos[i] = a.pos[p[i]];
+			b.ori[i] = g.mul(t[i], a.ori[p[i]]);
+		}
+	}
+	void twistRowScalar(const twistTable& t, int r, unsigned char* o, size_t n)
+	{
+		const unsigned char* row = t.row[r];
+		size_t i;
+		for (i = 0; i < n; ++i)
+			o[i] = row[o[i]];
+	}
+
+#ifdef MOVE_KERNEL_X86
+	KERNEL_TARGET("sse4.1") inline __m128i gatherSse4(const __m128i* src, const unsigned char* shuffle)
+	{
+		__m128i x;
+		x = _mm_shuffle_epi8(src[0], _mm_load_si128((const __m128i*)shuffle));
+		x = _mm_or_si128(x, _mm_shuffle_epi8(src[1], _mm_load_si128((const __m128i*)(shuffle + 96))));
+		return _mm_or_si128(x, _mm_shuffle_epi8(src[2], _mm_load_si128((const __m128i*)(shuffle + 192))));
+	}
+	KERNEL_TARGET("sse4.1") inline __m128i twistSse4(__m128i x, __m128i lo, __m128i hi, const unsigned char* turn)
+	{
+		__m128i y;
+		y = _mm_blendv_epi8(_mm_shuffle_epi8(lo, x), _mm_shuffle_epi8(hi, _mm_sub_epi8(x, _mm_set1_epi8(16))), _mm_cmpgt_epi8(x, _mm_set1_epi8(15)));
+		return _mm_blendv_epi8(x, y, _mm_load_si128((const __m128i*)turn));
+	}
+	KERNEL_TARGET("sse4.1") void applySse4(const twistTable& t, const octaState& a, int m, octaState& b)
+	{
+		const unsigned char* sh = t.shuffle[m][0];
+		const __m128i lo = _mm_load_si128((const __m128i*)t.row[t.rot[m]]);
+		const __m128i hi = _mm_load_si128((const __m128i*)(t.row[t.rot[m]] + 16));
+		__m128i p[3], o[3], x[6];
+		p[0] = _mm_loadu_si128((const __m128i*)a.pos);
+		p[1] = _mm_loadu_si128((const __m128i*)(a.pos + 16));
+		p[2] = _mm_loadu_si128((const __m128i*)(a.pos + 32));
+		o[0] = _mm_loadu_si128((const __m128i*)a.ori);
+		o[1] = _mm_loadu_si128((const __m128i*)(a.ori + 16));
+		o[2] = _mm_loadu_si128((const __m128i*)(a.ori + 32));
+		x[0] = gatherSse4(p, sh);
+		x[1] = gatherSse4(p, sh + 16);
+		x[2] = gatherSse4(p, sh + 32);
+		x[3] = twistSse4(gatherSse4(o, sh + 48), lo, hi, t.turn[m] + 48);
+		x[4] = twistSse4(gatherSse4(o, sh + 64), lo, hi, t.turn[m] + 64);
+		x[5] = twistSse4(gatherSse4(o, sh + 80), lo, hi, t.turn[m] + 80);
+		_mm_storeu_si128((__m128i*)b.pos, x[0]);
+		_mm_storeu_si128((__m128i*)(b.pos + 16), x[1]);
+		_mm_storeu_si128((__m128i*)(b.pos + 32), x[2]);
+		_mm_storeu_si128((__m128i*)b.ori, x[3]);
+		_mm_storeu_si128((__m128i*)(b.ori + 16), x[4]);
+		_mm_storeu_si128((__m128i*)(b.ori + 32), x[5]);
+	}
+
+	// The three 32-byte outputs are pos[0..31], pos[32..47]+ori[0..15] and
+	// ori[16..47]. vpshufb stays within 128-bit lanes, so each output is fed
+	// from sources that hold the matching pos or ori lane in each half.
+	KERNEL_TARGET("avx2") inline __m256i gatherAvx2(__m256i s0, __m256i s1, __m256i s2, const unsigned char* shuffle)
+	{
+		__m256i x;
+		x = _mm256_shuffle_epi8(s0, _mm256_load_si256((const __m256i*)shuffle));
+		x = _mm256_or_si256(x, _mm256_shuffle_epi8(s1, _mm256_load_si256((const __m256i*)(shuffle + 96))));
+		return _mm256_or_si256(x, _mm256_shuffle_epi8(s2, _mm256_load_si256((const __m256i*)(shuffle + 192))));
+	}
+	KERNEL_TARGET("avx2") inline __m256i twistAvx2(__m256i x, __m256i lo, __m256i hi, const unsigned char* turn)
+	{
+		__m256i y;
+		y = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, x), _mm256_shuffle_epi8(hi, _mm256_sub_epi8(x, _mm256_set1_epi8(16))), _mm256_cmpgt_epi8(x, _mm256_set1_epi8(15)));
+		return _mm256_blendv_epi8(x, y, _mm256_load_si256((const __m256i*)turn));
+	}
+	KERNEL_TARGET("avx2") void applyAvx2(const twistTable& t, const octaState& a, int m, octaState& b)
+	{
+		const unsigned char* sh = t.shuffle[m][0];
+		const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)t.row[t.rot[m]]));
+		const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)(t.row[t.rot[m]] + 16)));
+		const __m256i r0 = _mm256_loadu_si256((const __m256i*)a.pos);
+		const __m256i r1 = _mm256_loadu_si256((const __m256i*)(a.pos + 32));
+		const __m256i r2 = _mm256_loadu_si256((const __m256i*)(a.pos + 64));
+		__m256i x0, x1, x2;
+		x0 = gatherAvx2(_mm256_permute2x128_si256(r0, r0, 0x00), _mm256_permute2x128_si256(r0, r0, 0x11),
+			_mm256_permute2x128_si256(r1, r1, 0x00), sh);
+		x1 = gatherAvx2(_mm256_blend_epi32(r0, r1, 0xf0), _mm256_permute2x128_si256(r0, r2, 0x21),
+			_mm256_blend_epi32(r1, r2, 0xf0), sh + 32);
+		x2 = gatherAvx2(_mm256_permute2x128_si256(r1, r1, 0x11), _mm256_permute2x128_si256(r2, r2, 0x00),
+			_mm256_permute2x128_si256(r2, r2, 0x11), sh + 64);
+		x1 = twistAvx2(x1, lo, hi, t.turn[m] + 32);
+		x2 = twistAvx2(x2, lo, hi, t.turn[m] + 64);
+		_mm256_storeu_si256((__m256i*)b.pos, x0);
+		_mm256_storeu_si256((__m256i*)(b.pos + 32), x1);
+		_mm256_storeu_si256((__m256i*)(b.pos + 64), x2);
+	}
+
+	KERNEL_TARGET("sse4.1") void twistRowSse4(const twistTable& t, int r, unsigned char* o, size_t n)
+	{
+		const __m128i lo = _mm_load_si128((const __m128i*)t.row[r]);
+		const __m128i hi = _mm_load_si128((const __m128i*)(t.row[r] + 16));
+		__m128i x, y;
+		size_t i;
+		for (i = 0; i + 16 <= n; i += 16)
+		{
+			x = _mm_loadu_si128((const __m128i*)(o + i));
+			y = _mm_blendv_epi8(_mm_shuffle_epi8(lo, x), _mm_shuffle_epi8(hi, _mm_sub_epi8(x, _mm_set1_epi8(16))), _mm_cmpgt_epi8(x, _mm_set1_epi8(15)));
+			_mm_storeu_si128((__m128i*)(o + i), y);
+		}
+		twistRowScalar(t, r, o + i, n - i);
+	}
+	KERNEL_TARGET("avx2") void twistRowAvx2(const twistTable& t, int r, unsigned char* o, size_t n)
+	{
+		const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)t.row[r]));
+		const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)(t.row[r] + 16)));
+		__m256i x, y;
+		size_t i;
+		for (i = 0; i + 32 <= n; i += 32)
+		{
+			x = _mm256_loadu_si256((const __m256i*)(o + i));
+			y = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, x), _mm256_shuffle_epi8(hi, _mm256_sub_epi8(x, _mm256_set1_epi8(16))), _mm256_cmpgt_epi8(x, _mm256_set1_epi8(15)));
+			_mm256_storeu_si256((__m256i*)(o + i), y);
+		}
+		twistRowScalar(t, r, o + i, n - i);
+	}
+
+	bool cpuHas(bool avx2)
+	{
+#if defined(_MSC_VER)
+		int r[4];
+		__cpuid(r, 1);
+		if (!avx2)
+			return (r[2] & (1 << 19)) != 0;
+		if ((r[2] & (1 << 27)) == 0 || (r[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+			return false;
+		__cpuidex(r, 7, 0);
+		return (r[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("sse4.1");
+#endif
+	}
+#endif
+
+	typedef void (*moveKernelFn)(const twistTable&, const octaState&, int, octaState&);
+	typedef void (*twistKernelFn)(const twistTable&, int, unsigned char*, size_t);
+	struct kernelChoice
+	{
+		const twistTable& table;
+		moveKernelFn fn;
+		twistKernelFn twist;
+		const char* name;
+		kernelChoice() : table(twists())
+		{
+			fn = applyScalar;
+			twist = twistRowScalar;
+			name = "scalar";
+#ifdef MOVE_KERNEL_X86
+			if (cpuHas(true))
+			{
+				fn = applyAvx2;
+				twist = twistRowAvx2;
+				name = "avx2";
+			}
+			else if (cpuHas(false))
+			{
+				fn = applySse4;
+				twist = twistRowSse4;
+				name = "sse4";
+			}
+#endif
+		}
+	};
+	const kernelChoice& kernel()
+	{
+		static const kernelChoice k;
+		return k;
+	}
+}
+
+std::string moveName(int m)
+{
+	return std::to_string(moveId(m)) + (moveShift(m) < 0 ? "'" : "");
+}
+std::string formatMoves(const std::vector<int>& seq)
+{
+	std::string s;
+	size_t i;
+	for (i = 0; i < seq.size(); ++i)
+		s += (i ? " " : "") + moveName(seq[i]);
+	return s;
+}
+std::vector<int> parseMoves(const std::string& text)
+{
+	std::istringstream in(text);
+	std::vector<int> seq;
+	std::string w;
+	size_t end;
+	int q;
+	while (in >> w)
+	{
+		q = 0;
+		try
+		{
+			q = std::stoi(w, &end);
+		}
+		catch (std::exception&)
+		{
+			end = 0;
+		}
+		if (end == 0 || q < 1 || q > moveCount / 2 || w.size() > end + 1 || (w.size() == end + 1 && w[end] != '\''))
+			throw std::invalid_argument("bad move: " + w);
+		seq.push_back(moveIndex(q, w.size() > end ? -1 : 1));
+	}
+	return seq;
+}
+uint64_t parseMoveSet(const std::string& text)
+{
+	uint64_t mask = 0;
+	size_t i, j, dash, end = 0, endB = 0;
+	int a, b, q;
+	if (text == "all")
+		return allMoves;
+	if (text == "face")
+		return faceMoves;
+	if (text == "corner")
+		return cornerMoves;
+	for (i = 0; i < text.size(); i = j + 1)
+	{
+		j = std::min(text.find(',', i), text.size());
+		dash = std::min(text.find('-', i), j);
+		try
+		{
+			a = std::stoi(text.substr(i, dash - i), &end);
+			b = a;
+			if (dash < j)
+				b = std::stoi(text.substr(dash + 1, j - dash - 1), &endB);
+		}
+		catch (std::exception&)
+		{
+			throw std::invalid_argument("bad move set: " + text);
+		}
+		if (end != dash - i || (dash < j && endB != j - dash - 1) || a < 1 || b > moveCount / 2 || a > b)
+			throw std::invalid_argument("bad move set: " + text);
+		for (q = a; q <= b; ++q)
+			mask |= 3ull << moveIndex(q, 1);
+	}
+	if (!mask)
+		throw std::invalid_argument("empty move set");
+	return mask;
+}
+std::vector<int> invertMoves(const std::vector<int>& seq)
+{
+	std::vector<int> inv(seq.rbegin(), seq.rend());
+	size_t i;
+	for (i = 0; i < inv.size(); ++i)
+		inv[i] ^= 1;
+	return inv;
+}
+
+int moveRotation(int m)
+{
+	return twists().rot[m];
+}
+const char* moveKernel()
+{
+	return kernel().name;
+}
+void applyMove(const octaState& a, int m, octaState& b)
+{
+	const kernelChoice& k = kernel();
+	k.fn(k.table, a, m, b);
+}
+void twistOrientations(int r, unsigned char* ori, size_t n)
+{
+	const kernelChoice& k = kernel();
+	if (r != 0)
+		k.twist(k.table, r, ori, n);
+}
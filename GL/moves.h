@@ -0,0 +1,119 @@
+#pragma once
+#include "octaState.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Position cycles of the positive turns. A positive turn carries the piece at
+// c[k + 1] to c[k], the same way task() animates it.
+const int faceCycle[8][5][3] = {
+	{ { 0, 17, 19}, {1, 9, 10}, {5, 18, 6} , {4, 25, 11}, {16, 26, 2} },
+	{ { 0, 19, 21}, {2, 11, 12}, {6, 20, 7} , {1, 27, 13}, {10, 28, 3} },
+	{ { 0, 21, 23}, {3, 13, 14}, {7, 22, 8} , {2, 29, 15}, {12, 30, 4} },
+	{ { 0, 23, 17}, {4, 15, 16}, {8, 24, 5} , {3, 31, 9}, {14, 32, 1} },
+	{ { 41, 19, 17}, {37, 26, 25}, {34, 18, 33} , {38, 10, 32}, {27, 9, 40} },
+	{ { 41, 21, 19}, {38, 28, 27}, {35, 20, 34} , {39, 12, 26}, {29, 11, 37} },
+	{ { 41, 23, 21}, {39, 30, 29}, {36, 22, 35} , {40, 14, 28}, {31, 13, 38} },
+	{ { 41, 17, 23}, {40, 32, 31}, {33, 24, 36} , {37, 16, 30}, {25, 15, 39} } };
+const int cornerTip[6] = { 0, 17, 19, 21, 23, 41 };
+const int cornerCycle[6][2][4] = {
+	{ {1,2,3,4}, {5,6,7,8} },
+	{ {9,16,32,25}, {18,5,24,33} },
+	{ {11,10,26,27}, {6,18,34,20} },
+	{ {13,12,28,29}, {22,7,20,35} },
+	{ {15,14,30,31}, {8,22,36,24} },
+	{ {40,39,38,37}, {36,35,34,33} } };
+
+// Move m is addTask id m / 2 + 1, turned counterclockwise (shift -1) when m is odd.
+const int moveCount = 40;
+inline int moveIndex(int q, int shift)
+{
+	return (q - 1) * 2 + (shift < 0);
+}
+inline int moveId(int m)
+{
+	return m / 2 + 1;
+}
+inline int moveShift(int m)
+{
+	return m % 2 ? -1 : 1;
+}
+// Face turns are 120 degrees, corner turns 90.
+inline int moveOrder(int m)
+{
+	return m < 16 ? 3 : 4;
+}
+// Move sets are bit masks over move indices.
+const uint64_t allMoves = (1ull << moveCount) - 1;
+const uint64_t faceMoves = (1ull << 16) - 1;
+const uint64_t cornerMoves = allMoves & ~faceMoves;
+
+struct moveTable
+{
+	unsigned char perm[moveCount][42];
+	unsigned char turn[moveCount][42];
+};
+constexpr moveTable makeMoveTable()
+{
+	moveTable t{};
+	int m = 0, q = 0, i = 0, j = 0, k = 0, n = 0;
+	for (m = 0; m < moveCount; ++m)
+		for (i = 0; i < 42; ++i)
+			t.perm[m][i] = i;
+	for (q = 0; q < 20; ++q)
+	{
+		m = q * 2;
+		if (q < 8)
+		{
+			for (i = 0; i < 5; ++i)
+				for (j = 0; j < 3; ++j)
+				{
+					t.perm[m][faceCycle[q][i][j]] = faceCycle[q][i][(j + 1) % 3];
+					t.turn[m][faceCycle[q][i][j]] = 1;
+				}
+		}
+		else
+		{
+			k = (q - 8) / 2;
+			t.turn[m][cornerTip[k]] = 1;
+			if (q % 2)
+				for (i = 0; i < 2; ++i)
+					for (j = 0; j < 4; ++j)
+					{
+						t.perm[m][cornerCycle[k][i][j]] = cornerCycle[k][i][(j + 1) % 4];
+						t.turn[m][cornerCycle[k][i][j]] = 1;
+					}
+		}
+		for (i = 0; i < 42; ++i)
+		{
+			n = t.perm[m][i];
+			t.perm[m + 1][n] = i;
+			t.turn[m + 1][i] = t.turn[m][i];
+		}
+	}
+	return t;
+}
+constexpr moveTable moves = makeMoveTable();
+
+// Moves are written as their addTask id, with a trailing ' for shift -1.
+std::string moveName(int m);
+std::string formatMoves(const std::vector<int>& seq);
+std::vector<int> parseMoves(const std::string& text);
+// A move set written as all, face, corner or a ','-separated list of addTask
+// ids and id ranges such as 9-12; both turns of every id are in the set.
+uint64_t parseMoveSet(const std::string& text);
+// The sequence that undoes seq.
+std::vector<int> invertMoves(const std::vector<int>& seq);
+
+int moveRotation(int m);
+const char* moveKernel();
+void applyMove(const octaState& a, int m, octaState& b);
+// Replaces every orientation index in ori[0..n) by rotation r times it.
+void twistOrientations(int r, unsigned char* ori, size_t n);
+inline void applyMove(octaState& s, int m)
+{
+	octaState t = s;
+	applyMove(t, m, s);
+}
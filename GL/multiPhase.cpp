@@ -0,0 +1,130 @@
+#include "multiPhase.h"
+#include "optimizer.h"
+
+#include <stdexcept>
+
+namespace
+{
+	// The inner-layer corner turns (even addTask ids 10-20) and the tip
+	// twists (odd ids 9-19).
+	const uint64_t cornerLayers = 0xcccccc0000ull;
+	const uint64_t tipTwists = 0x3333330000ull;
+}
+
+multiPhaseSolver::multiPhaseSolver(const std::vector<solvePhase>& chain, const std::string& dir)
+	: bestLength(0), expired(false), nodes(0)
+{
+	size_t i, j;
+	if (chain.empty() || chain.back().goalMask != 0)
+		throw std::invalid_argument("the last phase must end at solved");
+	phases.resize(chain.size());
+	for (i = 0; i < chain.size(); ++i)
+	{
+		phase& f = phases[i];
+		if (chain[i].patterns.size() > maxTables)
+			throw std::invalid_argument("too many pruning tables");
+		if (i > 0 && (chain[i].moveMask & ~chain[i - 1].goalMask))
+			throw std::invalid_argument("a phase uses moves outside the previous goal");
+		f.moveMask = chain[i].moveMask;
+		f.goalMask = chain[i].goalMask;
+		f.canon = &moveAutomaton::get(f.moveMask);
+		for (j = 0; j < chain[i].patterns.size(); ++j)
+			f.tables.add(chain[i].patterns[j], dir, f.moveMask, f.goalMask);
+		if (f.goalMask)
+			f.goal.reset(new stabilizerChain(f.goalMask));
+	}
+	group.reset(new stabilizerChain(phases[0].moveMask | phases[0].goalMask));
+}
+
+// The clock is only read every 1024 nodes.
+bool multiPhaseSolver::timeUp()
+{
+	if (!expired && (++nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline)
+		expired = true;
+	return expired;
+}
+bool multiPhaseSolver::reached(int p, const octaState& s, const int* dist) const
+{
+	const phase& f = phases[p];
+	int i;
+	for (i = 0; i < f.tables.size(); ++i)
+		if (dist[i] != 0)
+			return false;
+	return f.goal ? f.goal->contains(s) : s.solved();
+}
+// Returns true to stop the caller: after the last phase once a solution is
+// found, after any other once time is up. A phase that ends in a move of the
+// next one is skipped: the subgroup was reached one move earlier.
+bool multiPhaseSolver::search(int p, const octaState& s, const int* dist, int node, int begin, int g, int bound)
+{
+	const phase& f = phases[p];
+	octaState t;
+	int next[maxTables];
+	int m, after, h;
+	if (timeUp())
+		return true;
+	if (g == bound)
+	{
+		if (!reached(p, s, dist))
+			return false;
+		if (p + 1 == (int)phases.size())
+		{
+			best.assign(path, path + g);
+			bestLength = g;
+			return true;
+		}
+		if (g > begin && (phases[p + 1].moveMask >> path[g - 1] & 1))
+			return false;
+		if ((h = phases[p + 1].tables.estimate(s, next)) < 0)
+			return false;
+		for (; g + h < bestLength && g + h <= maxDepth; ++h)
+			if (search(p + 1, s, next, moveAutomaton::start, g, g, g + h))
+				break;
+		return expired;
+	}
+	for (m = 0; m < moveCount; ++m)
+		if ((after = f.canon->next(node, m)) >= 0)
+		{
+			applyMove(s, m, t);
+			if (!f.tables.update(dist, m, t, bound - g - 1, next))
+				continue;
+			path[g] = m;
+			if (search(p, t, next, after, begin, g + 1, bound))
+				return true;
+		}
+	return false;
+}
+std::vector<int> multiPhaseSolver::solve(const octaState& s, double seconds)
+{
+	int dist[maxTables];
+	int bound;
+	best.clear();
+	bestLength = maxDepth + 1;
+	expired = false;
+	nodes = 0;
+	deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+	if (!group->contains(s) || (bound = phases[0].tables.estimate(s, dist)) < 0)
+		throw std::invalid_argument("state is not reachable");
+	for (; bound < bestLength && bound <= maxDepth; ++bound)
+		if (search(0, s, dist, moveAutomaton::start, 0, 0, bound))
+			break;
+	if (best.empty() && !expired)
+		throw std::runtime_error("no solution within the depth limit");
+	return mergeMoves(best);
+}
+
+std::vector<solvePhase> defaultPhases()
+{
+	const uint64_t c1 = 0xc00000, c2 = 0xc000000, c5 = 0xc000000000;
+	return {
+		{ faceMoves | cornerLayers, cornerMoves | 0x3f, { "0:41+1:37,38,39,40" } },
+		{ cornerLayers | 0x3f, cornerMoves | 0xf, { "0:23@0,17,19,21,23+1:14,15,30,31@1,2,3,4,9,10,11,12,13,14,15,16,25,26,27,28,29,30,31,32" } },
+		{ cornerLayers | 0xf, cornerMoves | 0x3, { "0:21@0,17,19,21+1:12,13,28,29@1,2,3,4,9,10,11,12,13,16,25,26,27,28,29,32" } },
+		{ cornerLayers | 0x3, tipTwists | c1 | c2 | c5 | 0x3, { "2:7,8,22+1:3@1,2,3,4,9,10,11,16,25,26,27,32+1:12@12,13,28,29+1:14@14,15,30,31" } },
+		{ c1 | c2 | c5 | 0x3, tipTwists | c1 | c2 | c5, {
+			"0:0@0,17,19+1:1,2,4,9,16,25,32@1,2,4,9,10,11,16,25,26,27,32",
+			"0:0@0,17,19+1:1,2,4,10,11,26,27@1,2,4,9,10,11,16,25,26,27,32" } },
+		{ c1 | c2 | c5, tipTwists | c1 | c2, { "2:5=6=33=34,18=20=24,35,36@5,6,18,20,24,33,34,35,36+1:37@37,38,39,40" } },
+		{ c1 | c2, tipTwists, { "2:5,6,18,20,24,33,34@5,6,18,20,24,33,34+1:9@9,16,25,32+1:10@10,11,26,27" } },
+		{ tipTwists, 0, { "0" } } };
+}
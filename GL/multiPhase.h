@@ -0,0 +1,70 @@
+#pragma once
+#include "solver.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One step of a multi-phase solve. Using the moves in moveMask, it brings the
+// state into the subgroup goalMask generates, or to solved when goalMask is
+// 0. Its tables are built over those moves with that goal.
+struct solvePhase
+{
+	uint64_t moveMask;
+	uint64_t goalMask;
+	std::vector<std::string> patterns;
+};
+
+// Kociemba-style search down a chain of nested subgroups; two phases is his
+// solver. Each phase is an IDA* into the next subgroup, and every solution
+// of a phase is followed by the later phases held below the best total so
+// far, so the answer only improves until time runs out. A phase ends on an
+// exact membership test, so its tables only have to bound the distance.
+class multiPhaseSolver
+{
+private:
+	static const int maxTables = 16;
+	static const int maxDepth = 128;
+	struct phase
+	{
+		uint64_t moveMask;
+		uint64_t goalMask;
+		const moveAutomaton* canon;
+		pruningSet tables;
+		std::unique_ptr<stabilizerChain> goal;
+	};
+	std::vector<phase> phases;
+	std::unique_ptr<stabilizerChain> group;
+	int path[maxDepth];
+	std::vector<int> best;
+	int bestLength;
+	std::chrono::steady_clock::time_point deadline;
+	bool expired;
+	uint64_t nodes;
+	bool timeUp();
+	bool reached(int p, const octaState& s, const int* dist) const;
+	bool search(int p, const octaState& s, const int* dist, int node, int begin, int g, int bound);
+public:
+	// Loads or generates every phase's tables in dir. Each phase's moves
+	// must lie in the previous phase's goal.
+	multiPhaseSolver(const std::vector<solvePhase>& chain, const std::string& dir);
+	// Returns the best solution found within the time limit, or an empty one
+	// if there was none yet. The first solution of a random state takes a few
+	// milliseconds and about 70 moves; more time shortens it, but it is not
+	// optimal.
+	std::vector<int> solve(const octaState& s, double seconds);
+	uint64_t expanded() const
+	{
+		return nodes;
+	}
+};
+
+// The default chain drops the face turns down to the first one, then the
+// inner-layer turns of three corners, the first face and the other corners
+// in turn. Each table only ranks the slots its phase's moves can reach,
+// which keeps it small and close to exact. Tip twists (the odd addTask ids
+// 9-19) commute with every move that leaves tips in place, so only the last
+// phase uses them.
+std::vector<solvePhase> defaultPhases();
@@ -0,0 +1,94 @@
+#include "nearby.h"
+#include "automaton.h"
+#include "sequence.h"
+
+#include <stdexcept>
+
+namespace
+{
+	uint64_t keyOf(const octaState& s)
+	{
+		uint64_t h = s.hash();
+		return h ? h : 1;
+	}
+}
+
+// Entries pack the length in the low four bits and six bits per move above.
+nearbyStates::nearbyStates(int depth)
+	: depth(depth), slots(2 << 10, 0), count(0)
+{
+	octaState s;
+	if (depth < 1 || depth > 9)
+		throw std::invalid_argument("nearby depth must be 1 to 9");
+	enumerate(s, moveAutomaton::start, 0);
+}
+// The slot holding key, or the empty slot where it would go.
+size_t nearbyStates::find(uint64_t key) const
+{
+	size_t mask = slots.size() / 2 - 1, i = (size_t)key & mask;
+	while (slots[2 * i] && slots[2 * i] != key)
+		i = (i + 1) & mask;
+	return 2 * i;
+}
+void nearbyStates::grow()
+{
+	std::vector<uint64_t> old(slots.size() * 2, 0);
+	size_t i, j;
+	old.swap(slots);
+	for (i = 0; i < old.size(); i += 2)
+		if (old[i])
+		{
+			j = find(old[i]);
+			slots[j] = old[i];
+			slots[j + 1] = old[i + 1];
+		}
+}
+void nearbyStates::enumerate(const octaState& s, int node, int g)
+{
+	const moveAutomaton& canon = moveAutomaton::get();
+	uint64_t code = g;
+	octaState t;
+	uint64_t key = keyOf(s);
+	size_t k = find(key);
+	int i, m, after;
+	// A state already reached sooner has had everything below it reached
+	// sooner too.
+	if (slots[k] && (int)(slots[k + 1] & 15) < g)
+		return;
+	if (!slots[k] || (int)(slots[k + 1] & 15) > g)
+	{
+		for (i = 0; i < g; ++i)
+			code |= (uint64_t)path[i] << (4 + 6 * i);
+		if (!slots[k])
+		{
+			if (++count * 4 > slots.size())
+			{
+				grow();
+				k = find(key);
+			}
+			slots[k] = key;
+		}
+		slots[k + 1] = code;
+	}
+	if (g == depth)
+		return;
+	for (m = 0; m < moveCount; ++m)
+		if ((after = canon.next(node, m)) >= 0)
+		{
+			applyMove(s, m, t);
+			path[g] = m;
+			enumerate(t, after, g + 1);
+		}
+}
+// Hashes can collide, so a hit is compiled and compared before it is used.
+int nearbyStates::lookup(const octaState& t, int limit, std::vector<int>& seq) const
+{
+	size_t k = find(keyOf(t));
+	int i, n;
+	if (!slots[k] || (n = (int)(slots[k + 1] & 15)) >= limit)
+		return -1;
+	seq.resize(n);
+	for (i = 0; i < n; ++i)
+		seq[i] = (int)(slots[k + 1] >> (4 + 6 * i) & 63);
+	return compileSequence(seq) == t ? n : -1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "moves.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Every state within depth moves of solved, each with one shortest sequence
+// reaching it. The states sit in one open-addressed array keyed by state hash,
+// so a lookup is a single cache miss; depth 4 keeps about 490 thousand states
+// in 16 MB.
+class nearbyStates
+{
+private:
+	int depth;
+	// Pairs of hash and entry; a zero hash marks an empty slot.
+	std::vector<uint64_t> slots;
+	size_t count;
+	int path[16];
+	size_t find(uint64_t key) const;
+	void grow();
+	void enumerate(const octaState& s, int node, int g);
+public:
+	explicit nearbyStates(int depth = 4);
+	int getDepth() const
+	{
+		return depth;
+	}
+	size_t size() const
+	{
+		return count;
+	}
+	// The distance of t from solved if it is below limit, with a shortest
+	// sequence reaching it in seq; otherwise -1.
+	int lookup(const octaState& t, int limit, std::vector<int>& seq) const;
+};
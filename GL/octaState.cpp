@@ -0,0 +1,81 @@
+#include "octaState.h"
+
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <sstream>
+
+static_assert(sizeof(octaState) == 96 && offsetof(octaState, ori) == 48, "octaState must stay packed");
+
+void octaState::reset()
+{
+	int i;
+	for (i = 0; i < 48; ++i)
+	{
+		pos[i] = i < 42 ? i : 0;
+		ori[i] = 0;
+	}
+}
+bool octaState::solved() const
+{
+	int i;
+	for (i = 0; i < 42; ++i)
+		if (pos[i] != i || ori[i] != 0)
+			return false;
+	return true;
+}
+size_t octaState::hash() const
+{
+	const unsigned char* p = pos;
+	uint64_t h = 0xcbf29ce484222325ULL, w;
+	int i;
+	for (i = 0; i < 12; ++i)
+	{
+		std::memcpy(&w, p + i * 8, 8);
+		h = (h ^ w) * 0x100000001b3ULL;
+		h ^= h >> 29;
+	}
+	return (size_t)(h ^ (h >> 32));
+}
+bool octaState::operator==(const octaState& o) const
+{
+	return std::memcmp(pos, o.pos, sizeof(octaState)) == 0;
+}
+
+std::string formatState(const octaState& s)
+{
+	std::string t;
+	int i;
+	for (i = 0; i < 84; ++i)
+	{
+		if (i)
+			t += ' ';
+		t += std::to_string(i < 42 ? s.pos[i] : s.ori[i - 42]);
+	}
+	return t;
+}
+bool parseState(const std::string& text, octaState& s)
+{
+	std::istringstream in(text);
+	bool used[42] = { false };
+	int i, v;
+	octaState t;
+	for (i = 0; i < 84; ++i)
+	{
+		if (!(in >> v) || v < 0 || v >= (i < 42 ? 42 : 24))
+			return false;
+		if (i < 42)
+		{
+			if (used[v])
+				return false;
+			used[v] = true;
+			t.pos[i] = (unsigned char)v;
+		}
+		else
+			t.ori[i - 42] = (unsigned char)v;
+	}
+	if (in >> v)
+		return false;
+	s = t;
+	return true;
+}
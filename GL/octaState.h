@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Packed puzzle state: pos[i] is the piece sitting at position i and ori[i] its
+// orientation as an index into rotationGroup. This is the source of truth; the
+// render matrices are derived from it. Both arrays are padded to three 16-byte
+// lanes for the shuffle kernels; the padding is always zero.
+struct alignas(16) octaState
+{
+	unsigned char pos[48];
+	unsigned char ori[48];
+	octaState()
+	{
+		reset();
+	}
+	void reset();
+	bool solved() const;
+	size_t hash() const;
+	bool operator==(const octaState& o) const;
+	bool operator!=(const octaState& o) const
+	{
+		return !(*this == o);
+	}
+};
+// Text form: the 42 positions followed by the 42 orientations, space separated.
+std::string formatState(const octaState& s);
+bool parseState(const std::string& text, octaState& s);
+
+struct octaStateHash
+{
+	size_t operator()(const octaState& s) const
+	{
+		return s.hash();
+	}
+};
+
+// Turn axes for addTask ids 1..20, in the order task() animates them.
+const int turnAxis[20][3] = {
+	{ 1, 1, 1}, { 1,-1, 1}, {-1,-1, 1}, {-1, 1, 1},
+	{ 1, 1,-1}, { 1,-1,-1}, {-1,-1,-1}, {-1, 1,-1},
+	{ 0, 0, 1}, { 0, 0, 1}, { 0, 1, 0}, { 0, 1, 0},
+	{ 1, 0, 0}, { 1, 0, 0}, { 0,-1, 0}, { 0,-1, 0},
+	{-1, 0, 0}, {-1, 0, 0}, { 0, 0,-1}, { 0, 0,-1} };
@@ -0,0 +1,84 @@
+#include "optimizer.h"
+#include "automaton.h"
+
+#include <algorithm>
+
+// A run is kept as its addTask id and the number of positive turns it adds
+// up to, and written back with the fewest moves.
+std::vector<int> mergeMoves(const std::vector<int>& seq)
+{
+	const moveAutomaton& canon = moveAutomaton::get();
+	std::vector<int> id, amount, out;
+	size_t i;
+	int j, m, q, a, order;
+	for (i = 0; i < seq.size(); ++i)
+	{
+		m = seq[i];
+		q = moveId(m);
+		order = moveOrder(m);
+		a = moveShift(m) > 0 ? 1 : order - 1;
+		for (j = (int)id.size() - 1; j >= 0 && id[j] != q; --j)
+			if (!canon.commutes(moveIndex(id[j], 1), m))
+			{
+				j = -1;
+				break;
+			}
+		if (j >= 0)
+		{
+			amount[j] = (amount[j] + a) % order;
+			if (amount[j] == 0)
+			{
+				id.erase(id.begin() + j);
+				amount.erase(amount.begin() + j);
+			}
+		}
+		else
+		{
+			id.push_back(q);
+			amount.push_back(a);
+		}
+	}
+	for (i = 0; i < id.size(); ++i)
+	{
+		m = moveIndex(id[i], 1);
+		if (amount[i] == moveOrder(m) - 1)
+			out.push_back(m ^ 1);
+		else
+			out.insert(out.end(), amount[i], m);
+	}
+	return out;
+}
+
+sequenceOptimizer::sequenceOptimizer(int depth)
+	: near(depth)
+{
+}
+
+// Windows are tried longest first at each position. After a splice the scan
+// backs up by depth, as the shorter run may now merge with what came before.
+std::vector<int> sequenceOptimizer::optimize(const std::vector<int>& seq) const
+{
+	std::vector<int> s = mergeMoves(seq), best;
+	octaState t[16];
+	size_t i = 0, w, n;
+	while (i + 1 < s.size())
+	{
+		n = std::min(s.size() - i, (size_t)near.getDepth() + 1);
+		applyMove(octaState(), s[i], t[1]);
+		for (w = 2; w <= n; ++w)
+			applyMove(t[w - 1], s[i + w - 1], t[w]);
+		for (w = n; w >= 2; --w)
+			if (near.lookup(t[w], (int)w, best) >= 0)
+				break;
+		if (w < 2)
+		{
+			++i;
+			continue;
+		}
+		s.erase(s.begin() + i, s.begin() + i + w);
+		s.insert(s.begin() + i, best.begin(), best.end());
+		s = mergeMoves(s);
+		i = i > (size_t)near.getDepth() ? i - near.getDepth() : 0;
+	}
+	return s;
+}
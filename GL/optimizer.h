@@ -0,0 +1,23 @@
+#pragma once
+#include "moves.h"
+#include "nearby.h"
+
+#include <vector>
+
+// Brings a sequence to one of no greater length: a move is slid back over the
+// moves it commutes with onto an earlier turn of the same id, and the two are
+// added up, dropping out when they cancel.
+std::vector<int> mergeMoves(const std::vector<int>& seq);
+
+// Peephole optimizer for recorded sequences. A window of up to depth + 1
+// moves whose transform is a nearby state at a shorter distance is replaced,
+// so each window is solved optimally; a window that is not nearby is already
+// optimal.
+class sequenceOptimizer
+{
+private:
+	nearbyStates near;
+public:
+	explicit sequenceOptimizer(int depth = 4);
+	std::vector<int> optimize(const std::vector<int>& seq) const;
+};
@@ -0,0 +1,552 @@
+#include "orbit.h"
+#include "moves.h"
+#include "rotation.h"
+
+#include <bitset>
+#include <sstream>
+#include <stdexcept>
+
+static int findRoot(int* root, int i)
+{
+	while (root[i] != i)
+		i = root[i] = root[root[i]];
+	return i;
+}
+static int popcount(uint32_t x)
+{
+	return (int)std::bitset<32>(x).count();
+}
+
+orbitTable::orbitTable()
+{
+	const rotationGroup& g = rotationGroup::get();
+	int root[42], dest[moveCount][42], par[moveCount];
+	int queue[42 * 24], hold[24];
+	int basis[8] = { 0 };
+	bool seen[42][24], placed[42];
+	int i, j, m, o, x, y, r, s, d, head, tail, n;
+	octaState t;
+	for (i = 0; i < 42; ++i)
+		root[i] = i;
+	for (m = 0; m < moveCount; ++m)
+		for (i = 0; i < 42; ++i)
+		{
+			dest[m][moves.perm[m][i]] = i;
+			root[findRoot(root, i)] = findRoot(root, moves.perm[m][i]);
+		}
+	count = 0;
+	for (i = 0; i < 42; ++i)
+	{
+		for (o = 0; o < count && findRoot(root, info[o].slot[0]) != findRoot(root, i); ++o);
+		if (o == count)
+			info[count++].size = 0;
+		orbitOf[i] = o;
+		indexOf[i] = info[o].size;
+		info[o].slot[info[o].size++] = i;
+	}
+
+	// Follow a single piece through every move: the rotations it can have at
+	// its own slot form a cyclic group generated by s, and the first rotation
+	// that brings it to slot x is the transport of x.
+	for (x = 0; x < 42; ++x)
+	{
+		placed[x] = false;
+		for (r = 0; r < 24; ++r)
+		{
+			seen[x][r] = false;
+			digitOf[x][r] = -1;
+		}
+	}
+	for (o = 0; o < count; ++o)
+	{
+		x = info[o].slot[0];
+		head = tail = 0;
+		queue[tail++] = x * 24;
+		seen[x][0] = placed[x] = true;
+		transport[x] = 0;
+		while (head < tail)
+		{
+			x = queue[head] / 24;
+			r = queue[head++] % 24;
+			for (m = 0; m < moveCount; ++m)
+			{
+				if (!moves.turn[m][x])
+					continue;
+				y = dest[m][x];
+				s = g.mul(moveRotation(m), r);
+				if (seen[y][s])
+					continue;
+				seen[y][s] = true;
+				if (!placed[y])
+				{
+					placed[y] = true;
+					transport[y] = s;
+				}
+				queue[tail++] = y * 24 + s;
+			}
+		}
+		x = info[o].slot[0];
+		for (n = 0, r = 0; r < 24; ++r)
+			if (seen[x][r])
+				hold[n++] = r;
+		info[o].twists = n;
+		for (i = 0; i < n; ++i)
+		{
+			for (s = hold[i], d = 1; s != 0; s = g.mul(hold[i], s), ++d);
+			if (d == n)
+				break;
+		}
+		for (j = 0; j < info[o].size; ++j)
+		{
+			x = info[o].slot[j];
+			for (s = 0, d = 0; d < n; ++d, s = g.mul(hold[i], s))
+			{
+				digitRot[x][d] = g.mul(transport[x], s);
+				digitOf[x][digitRot[x][d]] = d;
+			}
+		}
+	}
+
+	for (m = 0; m < moveCount; ++m)
+	{
+		par[m] = 0;
+		for (i = 0; i < 42; ++i)
+			placed[i] = false;
+		for (i = 0; i < 42; ++i)
+			if (!placed[i])
+			{
+				for (j = i, n = 0; !placed[j]; j = moves.perm[m][j], ++n)
+					placed[j] = true;
+				if (n % 2 == 0)
+					par[m] ^= 1 << orbitOf[i];
+			}
+		t.reset();
+		applyMove(t, m);
+		for (o = 0; o < count; ++o)
+		{
+			for (d = 0, j = 0; j < info[o].size; ++j)
+				d += digit(t, info[o].slot[j]);
+			if (m == 0)
+			{
+				info[o].evenOnly = true;
+				info[o].twistSum = true;
+			}
+			info[o].evenOnly &= (par[m] >> o & 1) == 0;
+			info[o].twistSum &= d % info[o].twists == 0;
+		}
+	}
+	// A parity rule is a set of orbits whose parities every move flips an even
+	// number of times in total; keep an independent set of them.
+	parityRules = 0;
+	for (i = 1; i < 1 << count; ++i)
+	{
+		for (m = 0; m < moveCount && popcount(par[m] & i) % 2 == 0; ++m);
+		if (m < moveCount)
+			continue;
+		for (s = i, o = count - 1; o >= 0; --o)
+			if (s >> o & 1)
+			{
+				if (!basis[o])
+				{
+					basis[o] = s;
+					parityRule[parityRules++] = i;
+					break;
+				}
+				s ^= basis[o];
+			}
+	}
+}
+const orbitTable& orbitTable::get()
+{
+	static const orbitTable table;
+	return table;
+}
+int orbitTable::digit(const octaState& s, int x) const
+{
+	return digitOf[x][rotationGroup::get().mul(s.ori[x], transport[s.pos[x]])];
+}
+int orbitTable::rotation(int x, int piece, int d) const
+{
+	const rotationGroup& g = rotationGroup::get();
+	return g.mul(digitRot[x][d], g.inv(transport[piece]));
+}
+
+static uint64_t multiply(uint64_t a, uint64_t b)
+{
+	if (b != 0 && a > UINT64_MAX / b)
+		throw std::out_of_range("orbit coordinate does not fit in 64 bits");
+	return a * b;
+}
+
+static uint64_t choose(int n, int k)
+{
+	uint64_t c = 1;
+	int i;
+	if (k < 0 || k > n)
+		return 0;
+	for (i = 0; i < k; ++i)
+		c = c * (n - i) / (i + 1);
+	return c;
+}
+
+static std::vector<std::vector<int>> singletons(const std::vector<int>& pieces)
+{
+	std::vector<std::vector<int>> g;
+	size_t i;
+	for (i = 0; i < pieces.size(); ++i)
+		g.push_back(std::vector<int>(1, pieces[i]));
+	return g;
+}
+static std::vector<int> orbitSlots(int orbit)
+{
+	const orbitInfo& o = orbitTable::get().orbit(orbit);
+	return std::vector<int>(o.slot, o.slot + o.size);
+}
+
+orbitCoord::orbitCoord(int orbit) : orbitCoord(orbit, orbitSlots(orbit))
+{
+}
+orbitCoord::orbitCoord(int orbit, const std::vector<int>& pieces) : orbitCoord(orbit, singletons(pieces))
+{
+}
+orbitCoord::orbitCoord(int orbit, const std::vector<std::vector<int>>& pieceGroups)
+	: orbitCoord(orbit, pieceGroups, orbitSlots(orbit))
+{
+}
+orbitCoord::orbitCoord(int orbit, const std::vector<std::vector<int>>& pieceGroups, const std::vector<int>& slots)
+{
+	const orbitTable& t = orbitTable::get();
+	const orbitInfo& o = t.orbit(orbit);
+	bool inSlots[42] = { false };
+	int i, j, p, rest;
+	orb = orbit;
+	n = (int)slots.size();
+	k = 0;
+	twists = o.twists;
+	groups = (int)pieceGroups.size();
+	if (n < 1 || n > o.size)
+		throw std::invalid_argument("bad slot count for orbit coordinate");
+	for (i = 0; i < n; ++i)
+	{
+		p = slot[i] = slots[i];
+		if (p < 0 || p >= 42 || t.orbitOfSlot(p) != orbit || inSlots[p])
+			throw std::invalid_argument("bad slot list for orbit coordinate");
+		inSlots[p] = true;
+	}
+	for (i = 0; i < 42; ++i)
+		index[i] = label[i] = -1;
+	for (i = 0; i < groups; ++i)
+	{
+		groupSize[i] = (int)pieceGroups[i].size();
+		if (groupSize[i] < 1 || k + groupSize[i] > n)
+			throw std::invalid_argument("bad piece count for orbit coordinate");
+		for (j = 0; j < groupSize[i]; ++j)
+		{
+			p = pieceGroups[i][j];
+			if (p < 0 || p >= 42 || t.orbitOfSlot(p) != orbit)
+				throw std::invalid_argument("piece is not in the orbit");
+			if (index[p] >= 0)
+				throw std::invalid_argument("piece is listed twice");
+			if (!inSlots[p])
+				throw std::invalid_argument("piece is outside the coordinate's slots");
+			piece[k] = p;
+			index[p] = (signed char)k++;
+			label[p] = (signed char)i;
+		}
+	}
+	if (k < 1)
+		throw std::invalid_argument("bad piece count for orbit coordinate");
+	if (groups == k)
+		groups = 0;
+	even = !groups && k == o.size && o.evenOnly;
+	sumFixed = !groups && k == o.size && o.twistSum;
+	permSize = 1;
+	if (groups)
+	{
+		// k! / (size0! size1! ...), built one group at a time.
+		labelSize = 1;
+		for (rest = 0, i = 0; i < (int)pieceGroups.size(); ++i)
+		{
+			rest += groupSize[i];
+			labelSize = multiply(labelSize, choose(rest, groupSize[i]));
+		}
+		permSize = multiply(choose(n, k), labelSize);
+		multiply(labelSize, k);
+	}
+	else
+		for (i = 0; i < k; ++i)
+			permSize = multiply(permSize, n - i);
+	if (even)
+		permSize /= 2;
+	twistSize = 1;
+	for (i = sumFixed; i < k; ++i)
+		twistSize = multiply(twistSize, twists);
+	multiply(permSize, twistSize);
+}
+std::string orbitCoord::name() const
+{
+	std::string s = std::to_string(orb);
+	int i;
+	if (k == orbitTable::get().orbit(orb).size && !groups)
+		return s;
+	for (i = 0; i < k; ++i)
+		s += (i == 0 ? ":" : groups && label[piece[i]] == label[piece[i - 1]] ? "=" : ",") + std::to_string(piece[i]);
+	if (n < orbitTable::get().orbit(orb).size)
+		for (i = 0; i < n; ++i)
+			s += (i == 0 ? "@" : ",") + std::to_string(slot[i]);
+	return s;
+}
+uint64_t orbitCoord::rank(const octaState& s) const
+{
+	const orbitTable& t = orbitTable::get();
+	int at[24], d[24], i, j, a, x, found = 0;
+	uint64_t pr = 0, tr = 0;
+	if (groups)
+		return rankGroups(s);
+	for (i = 0; i < n; ++i)
+	{
+		x = slot[i];
+		j = index[s.pos[x]];
+		if (j < 0)
+			continue;
+		at[j] = i;
+		d[j] = t.digit(s, x);
+		++found;
+	}
+	if (found < k)
+		throw std::invalid_argument("piece is outside the coordinate's slots");
+	for (i = 0; i < k; ++i)
+	{
+		for (a = at[i], j = 0; j < i; ++j)
+			a -= at[j] < at[i];
+		pr = pr * (n - i) + a;
+	}
+	if (even)
+		pr /= 2;
+	for (i = 0; i < k - sumFixed; ++i)
+		tr = tr * twists + d[i];
+	return pr * twistSize + tr;
+}
+// Writes the chosen pieces into their slots; the rest of the coordinate's
+// slots are filled in slot order with digit 0.
+void orbitCoord::unrank(uint64_t r, octaState& s) const
+{
+	const orbitTable& t = orbitTable::get();
+	int c[24], d[24], i, j, a, p, sum = 0, parity = 0;
+	bool inPattern[42] = { false };
+	uint32_t used = 0;
+	uint64_t pr = r / twistSize, tr = r % twistSize;
+	if (groups)
+	{
+		unrankGroups(r, s);
+		return;
+	}
+	if (even)
+		pr *= 2;
+	for (i = k - 1; i >= 0; --i)
+	{
+		c[i] = (int)(pr % (n - i));
+		pr /= n - i;
+		parity += c[i];
+	}
+	if (even && parity % 2)
+		c[n - 2] = 1;
+	for (i = k - 1 - sumFixed; i >= 0; --i)
+	{
+		d[i] = (int)(tr % twists);
+		tr /= twists;
+		sum += d[i];
+	}
+	if (sumFixed)
+		d[k - 1] = (twists - sum % twists) % twists;
+	for (i = 0; i < k; ++i)
+	{
+		for (a = 0, j = c[i]; ; ++a)
+			if (!(used >> a & 1) && j-- == 0)
+				break;
+		used |= 1u << a;
+		s.pos[slot[a]] = piece[i];
+		s.ori[slot[a]] = t.rotation(slot[a], piece[i], d[i]);
+		inPattern[piece[i]] = true;
+	}
+	for (a = 0, i = 0; i < n; ++i)
+	{
+		p = slot[i];
+		if (inPattern[p])
+			continue;
+		for (; used >> a & 1; ++a);
+		used |= 1u << a;
+		s.pos[slot[a]] = p;
+		s.ori[slot[a]] = t.rotation(slot[a], p, 0);
+	}
+}
+
+// The slot set is ranked in the combinatorial number system; the group
+// sequence counts, for each slot, the arrangements that would have put an
+// earlier group there.
+uint64_t orbitCoord::rankGroups(const octaState& s) const
+{
+	const orbitTable& t = orbitTable::get();
+	int left[24], i, j = 0, g, l, x;
+	uint64_t slots = 0, order = 0, tr = 0, m = labelSize;
+	for (g = 0; g < groups; ++g)
+		left[g] = groupSize[g];
+	for (i = 0; i < n; ++i)
+	{
+		x = slot[i];
+		l = label[s.pos[x]];
+		if (l < 0)
+			continue;
+		slots += choose(i, j + 1);
+		for (g = 0; g < l; ++g)
+			order += m * left[g] / (k - j);
+		m = m * left[l] / (k - j);
+		--left[l];
+		tr = tr * twists + t.digit(s, x);
+		++j;
+	}
+	if (j < k)
+		throw std::invalid_argument("piece is outside the coordinate's slots");
+	return (slots * labelSize + order) * twistSize + tr;
+}
+void orbitCoord::unrankGroups(uint64_t r, octaState& s) const
+{
+	const orbitTable& t = orbitTable::get();
+	int left[24], next[24], at[24], d[24], i, j, g, a, p;
+	bool inPattern[42] = { false }, used[24] = { false };
+	uint64_t tr = r % twistSize, slots = r / twistSize / labelSize, order = r / twistSize % labelSize;
+	uint64_t m = labelSize, c;
+	for (j = k - 1; j >= 0; --j)
+	{
+		d[j] = (int)(tr % twists);
+		tr /= twists;
+	}
+	for (j = k - 1, a = n - 1; j >= 0; --j)
+	{
+		for (; choose(a, j + 1) > slots; --a);
+		slots -= choose(a, j + 1);
+		at[j] = a;
+		used[a] = true;
+		--a;
+	}
+	for (g = 0, p = 0; g < groups; ++g)
+	{
+		left[g] = groupSize[g];
+		next[g] = p;
+		p += groupSize[g];
+	}
+	for (j = 0; j < k; ++j)
+	{
+		for (g = 0; ; ++g)
+		{
+			if (!left[g])
+				continue;
+			c = m * left[g] / (k - j);
+			if (order < c)
+				break;
+			order -= c;
+		}
+		m = c;
+		--left[g];
+		p = piece[next[g]++];
+		s.pos[slot[at[j]]] = p;
+		s.ori[slot[at[j]]] = t.rotation(slot[at[j]], p, d[j]);
+		inPattern[p] = true;
+	}
+	for (a = 0, i = 0; i < n; ++i)
+	{
+		p = slot[i];
+		if (inPattern[p])
+			continue;
+		for (; used[a]; ++a);
+		used[a] = true;
+		s.pos[slot[a]] = p;
+		s.ori[slot[a]] = t.rotation(slot[a], p, 0);
+	}
+}
+
+patternCoord::patternCoord(const std::vector<orbitCoord>& p) : parts(p), total(1)
+{
+	size_t i;
+	for (i = 0; i < parts.size(); ++i)
+		total = multiply(total, parts[i].size());
+}
+patternCoord::patternCoord(const std::string& spec) : total(1)
+{
+	std::stringstream in(spec);
+	std::string item, group, num;
+	std::vector<std::vector<int>> pieces;
+	std::vector<int> slots;
+	size_t colon, at;
+	while (std::getline(in, item, '+'))
+	{
+		slots.clear();
+		if ((at = item.find('@')) != std::string::npos)
+		{
+			std::stringstream list(item.substr(at + 1));
+			while (std::getline(list, num, ','))
+				slots.push_back(std::stoi(num));
+			item.erase(at);
+		}
+		colon = item.find(':');
+		if (colon == std::string::npos && slots.empty())
+			parts.push_back(orbitCoord(std::stoi(item)));
+		else if (colon == std::string::npos)
+			parts.push_back(orbitCoord(std::stoi(item), singletons(slots), slots));
+		else
+		{
+			std::stringstream list(item.substr(colon + 1));
+			pieces.clear();
+			while (std::getline(list, group, ','))
+			{
+				std::stringstream same(group);
+				pieces.push_back(std::vector<int>());
+				while (std::getline(same, num, '='))
+					pieces.back().push_back(std::stoi(num));
+			}
+			if (slots.empty())
+				parts.push_back(orbitCoord(std::stoi(item.substr(0, colon)), pieces));
+			else
+				parts.push_back(orbitCoord(std::stoi(item.substr(0, colon)), pieces, slots));
+		}
+		total = multiply(total, parts.back().size());
+	}
+	if (parts.empty())
+		throw std::invalid_argument("empty pattern");
+}
+std::string patternCoord::name() const
+{
+	std::string s;
+	size_t i;
+	for (i = 0; i < parts.size(); ++i)
+		s += (i ? "+" : "") + parts[i].name();
+	return s;
+}
+bool patternCoord::touches(int m) const
+{
+	const orbitTable& t = orbitTable::get();
+	size_t i;
+	int j;
+	for (i = 0; i < parts.size(); ++i)
+		for (j = 0; j < t.orbit(parts[i].getOrbit()).size; ++j)
+			if (moves.turn[m][t.orbit(parts[i].getOrbit()).slot[j]])
+				return true;
+	return false;
+}
+uint64_t patternCoord::rank(const octaState& s) const
+{
+	uint64_t r = 0;
+	size_t i;
+	for (i = 0; i < parts.size(); ++i)
+		r = r * parts[i].size() + parts[i].rank(s);
+	return r;
+}
+void patternCoord::unrank(uint64_t r, octaState& s) const
+{
+	size_t i;
+	for (i = parts.size(); i-- > 0;)
+	{
+		parts[i].unrank(r % parts[i].size(), s);
+		r /= parts[i].size();
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+#include "octaState.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Orbits of piece positions, derived from the move tables: moves never carry a
+// piece from one orbit into another. Within an orbit a piece's orientation is
+// a digit in [0, twists) relative to its position, and every move adds a fixed
+// amount to the digit of each piece it carries.
+struct orbitInfo
+{
+	int size;
+	int slot[24];
+	int twists;
+	bool evenOnly;
+	bool twistSum;
+};
+class orbitTable
+{
+private:
+	int count;
+	orbitInfo info[8];
+	int orbitOf[42];
+	int indexOf[42];
+	int parityRule[8];
+	int parityRules;
+	unsigned char transport[42];
+	signed char digitOf[42][24];
+	unsigned char digitRot[42][4];
+	orbitTable();
+public:
+	static const orbitTable& get();
+	int orbits() const
+	{
+		return count;
+	}
+	const orbitInfo& orbit(int o) const
+	{
+		return info[o];
+	}
+	int orbitOfSlot(int x) const
+	{
+		return orbitOf[x];
+	}
+	int indexOfSlot(int x) const
+	{
+		return indexOf[x];
+	}
+	// Bit o of a rule is set for every orbit whose permutation parity is
+	// summed; every reachable state has an even sum.
+	int parityRuleCount() const
+	{
+		return parityRules;
+	}
+	int parityMask(int i) const
+	{
+		return parityRule[i];
+	}
+	int digit(const octaState& s, int x) const;
+	int rotation(int x, int piece, int d) const;
+};
+
+// Rank of the placement and orientation digits of a chosen set of pieces of
+// one orbit. A coordinate over the whole orbit also drops what the orbit's
+// parity and twist constraints fix.
+//
+// Pieces can also be given in groups whose members are not told apart. Such
+// a coordinate ranks which slots hold pattern pieces, then which group sits
+// in each of them, then the digits in slot order.
+//
+// A coordinate can be limited to some of the orbit's slots. Its pieces must
+// then stay within them under every move it is used with; that keeps a table
+// for a subgroup that never leaves those slots small.
+class orbitCoord
+{
+private:
+	int orb;
+	int n;
+	int k;
+	int twists;
+	int slot[24];
+	int piece[24];
+	signed char index[42];
+	int groups;
+	signed char label[42];
+	int groupSize[24];
+	uint64_t labelSize;
+	bool even;
+	bool sumFixed;
+	uint64_t permSize;
+	uint64_t twistSize;
+	uint64_t rankGroups(const octaState& s) const;
+	void unrankGroups(uint64_t r, octaState& s) const;
+public:
+	explicit orbitCoord(int orbit);
+	orbitCoord(int orbit, const std::vector<int>& pieces);
+	orbitCoord(int orbit, const std::vector<std::vector<int>>& pieceGroups);
+	orbitCoord(int orbit, const std::vector<std::vector<int>>& pieceGroups, const std::vector<int>& slots);
+	int getOrbit() const
+	{
+		return orb;
+	}
+	int pieceCount() const
+	{
+		return k;
+	}
+	int slotCount() const
+	{
+		return n;
+	}
+	int getSlot(int i) const
+	{
+		return slot[i];
+	}
+	int getPiece(int i) const
+	{
+		return piece[i];
+	}
+	// Pieces with the same group are not told apart.
+	int pieceGroup(int i) const
+	{
+		return label[piece[i]];
+	}
+	uint64_t size() const
+	{
+		return permSize * twistSize;
+	}
+	std::string name() const;
+	uint64_t rank(const octaState& s) const;
+	void unrank(uint64_t r, octaState& s) const;
+};
+
+// Orbit coordinates ranked together as one mixed-radix index. The spec is a
+// '+'-separated list of "orbit" (whole orbit) or "orbit:piece,piece,...",
+// where pieces joined by '=' instead of ',' form one group. Either form may
+// end in "@slot,slot,..." to limit it to those slots.
+class patternCoord
+{
+private:
+	std::vector<orbitCoord> parts;
+	uint64_t total;
+public:
+	explicit patternCoord(const std::vector<orbitCoord>& p);
+	explicit patternCoord(const std::string& spec);
+	std::string name() const;
+	int partCount() const
+	{
+		return (int)parts.size();
+	}
+	const orbitCoord& part(int i) const
+	{
+		return parts[i];
+	}
+	uint64_t size() const
+	{
+		return total;
+	}
+	bool touches(int m) const;
+	uint64_t rank(const octaState& s) const;
+	void unrank(uint64_t r, octaState& s) const;
+};
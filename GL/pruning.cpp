@@ -0,0 +1,326 @@
+#include "pruning.h"
+#include "moves.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+namespace
+{
+	const uint32_t fileMagic = 0x5054434f;	// "OCTP"
+	const uint32_t fileVersion = 3;
+	// Work is handed out in chunks of indices; a multiple of 64 keeps every
+	// chunk on whole words of both the table and the frontier bitsets.
+	const uint64_t chunkSize = 1 << 14;
+
+	typedef std::unique_ptr<std::atomic<uint64_t>[]> atomicWords;
+
+	bool claim(std::atomic<uint64_t>* cell, uint64_t i, uint64_t v)
+	{
+		std::atomic<uint64_t>& w = cell[i >> 5];
+		int shift = (int)(i & 31) * 2;
+		uint64_t old = w.load(std::memory_order_relaxed);
+		while ((old >> shift & 3) == 3)
+			if (w.compare_exchange_weak(old, old & ~((3 ^ v) << shift), std::memory_order_relaxed))
+				return true;
+		return false;
+	}
+	void mark(std::atomic<uint64_t>* bits, uint64_t i)
+	{
+		bits[i >> 6].fetch_or(1ull << (i & 63), std::memory_order_relaxed);
+	}
+	bool marked(const std::atomic<uint64_t>* bits, uint64_t i)
+	{
+		return bits[i >> 6].load(std::memory_order_relaxed) >> (i & 63) & 1;
+	}
+}
+
+pruningTable::pruningTable(const patternCoord& c, uint64_t moveMask, uint64_t goalMask, uint64_t freeMask, bool reduced)
+	: coord(c), moveMask(moveMask), goalMask(goalMask), freeMask(freeMask & moveMask), activeMask(0), maxDepth(-1)
+{
+	octaState s;
+	int m;
+	for (m = 0; m < moveCount; ++m)
+		if ((moveMask >> m & 1) && coord.touches(m))
+		{
+			if (this->freeMask >> m & 1)
+				free.push_back(m);
+			else
+			{
+				active.push_back(m);
+				activeMask |= 1ull << m;
+			}
+		}
+	if (reduced)
+		sym = std::make_shared<symmetryCoord>(coord, moveMask, goalMask, this->freeMask);
+	solvedIndex = index(s);
+}
+// Walks to a neighbour one closer until none is; that index is a goal. With
+// free moves the neighbour may hang off any state they reach, so those are
+// searched breadth first.
+int pruningTable::distance(const octaState& s) const
+{
+	std::vector<octaState> queue;
+	std::unordered_set<uint64_t> seen;
+	octaState a = s, b;
+	uint64_t i = index(a), j = 0;
+	size_t k, q;
+	int d = 0, v;
+	if (data.empty() || get(i) == 3)
+		return -1;
+	if (maxDepth < 3)
+		return get(i);
+	for (;;)
+	{
+		v = get(i);
+		queue.assign(1, a);
+		seen.clear();
+		seen.insert(i);
+		for (q = 0; q < queue.size(); ++q)
+		{
+			for (k = 0; k < active.size(); ++k)
+			{
+				applyMove(queue[q], active[k], b);
+				j = index(b);
+				if (get(j) == (v + 2) % 3)
+					break;
+			}
+			if (k < active.size())
+				break;
+			for (k = 0; k < free.size(); ++k)
+			{
+				applyMove(queue[q], free[k], b);
+				if (seen.insert(index(b)).second)
+					queue.push_back(b);
+			}
+		}
+		if (q == queue.size())
+			return v == 0 ? d : -1;
+		a = b;
+		i = j;
+		++d;
+	}
+}
+// Exact distance of s when a state one move away is at distance d.
+int pruningTable::next(int d, const octaState& s) const
+{
+	return d + (get(index(s)) - d % 3 + 4) % 3 - 1;
+}
+std::string pruningTable::fileName() const
+{
+	std::ostringstream s;
+	std::string name;
+	s << "prune-" << coord.name();
+	if (moveMask != allMoves)
+		s << "-m" << std::hex << moveMask;
+	if (goalMask)
+		s << "-g" << std::hex << goalMask;
+	if (freeMask)
+		s << "-f" << std::hex << freeMask;
+	if (sym)
+		s << "-s";
+	s << ".bin";
+	name = s.str();
+	std::replace(name.begin(), name.end(), ':', '_');
+	std::replace(name.begin(), name.end(), ',', '-');
+	return name;
+}
+
+// Small levels push from the frontier; once the frontier outgrows what is
+// left, each unreached index pulls instead by looking for a frontier
+// neighbour. Moves come in inverse pairs, so both find the same next level.
+// Every level is then closed under the free moves, and the goal set under
+// the goal and free moves, by pushing at the same value.
+void pruningTable::generate(int threads)
+{
+	uint64_t n = size(), words = (n + 31) / 32, bitWords = (n + 63) / 64;
+	uint64_t i, reached, frontier;
+	atomicWords cell(new std::atomic<uint64_t>[words]);
+	atomicWords front(new std::atomic<uint64_t>[bitWords]);
+	atomicWords next(new std::atomic<uint64_t>[bitWords]);
+	atomicWords level(new std::atomic<uint64_t>[bitWords]);
+	std::vector<int> goal = free;
+	std::vector<std::thread> pool;
+	int t, d, m;
+	if (threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	for (m = 0; m < moveCount; ++m)
+		if ((goalMask >> m & 1) && !(freeMask >> m & 1) && coord.touches(m))
+			goal.push_back(m);
+	for (i = 0; i < words; ++i)
+		cell[i].store(~0ull, std::memory_order_relaxed);
+	for (i = 0; i < bitWords; ++i)
+	{
+		front[i].store(0, std::memory_order_relaxed);
+		next[i].store(0, std::memory_order_relaxed);
+		level[i].store(0, std::memory_order_relaxed);
+	}
+	claim(cell.get(), solvedIndex, 0);
+	mark(front.get(), solvedIndex);
+	mark(level.get(), solvedIndex);
+
+	auto sweep = [&](const std::vector<int>& list, uint64_t value, bool pull)
+	{
+		std::atomic<uint64_t> cursor(0), found(0);
+		auto work = [&]()
+		{
+			octaState a, b;
+			uint64_t begin, end, x, j, count = 0;
+			size_t k;
+			while ((begin = cursor.fetch_add(chunkSize)) < n)
+			{
+				end = std::min(begin + chunkSize, n);
+				for (x = begin; x < end; ++x)
+				{
+					if (pull)
+					{
+						if ((cell[x >> 5].load(std::memory_order_relaxed) >> (x & 31) * 2 & 3) != 3)
+							continue;
+						state(x, a);
+						for (k = 0; k < list.size(); ++k)
+						{
+							applyMove(a, list[k], b);
+							if (marked(front.get(), index(b)))
+								break;
+						}
+						if (k < list.size() && claim(cell.get(), x, value))
+						{
+							mark(next.get(), x);
+							mark(level.get(), x);
+							++count;
+						}
+					}
+					else
+					{
+						if (!(front[x >> 6].load(std::memory_order_relaxed) >> (x & 63)))
+						{
+							x |= 63;
+							continue;
+						}
+						if (!marked(front.get(), x))
+							continue;
+						state(x, a);
+						for (k = 0; k < list.size(); ++k)
+						{
+							applyMove(a, list[k], b);
+							j = index(b);
+							if (claim(cell.get(), j, value))
+							{
+								mark(next.get(), j);
+								mark(level.get(), j);
+								++count;
+							}
+						}
+					}
+				}
+			}
+			found += count;
+		};
+		for (t = 1; t < threads; ++t)
+			pool.push_back(std::thread(work));
+		work();
+		for (t = 0; t < (int)pool.size(); ++t)
+			pool[t].join();
+		pool.clear();
+		front.swap(next);
+		for (i = 0; i < bitWords; ++i)
+			next[i].store(0, std::memory_order_relaxed);
+		return found.load();
+	};
+
+	// Pushes the newest indices through list until nothing changes, then
+	// makes the whole level the frontier.
+	auto close = [&](const std::vector<int>& list, uint64_t value)
+	{
+		uint64_t total = 0, more;
+		while (!list.empty() && (more = sweep(list, value, false)) > 0)
+			total += more;
+		front.swap(level);
+		for (i = 0; i < bitWords; ++i)
+			level[i].store(0, std::memory_order_relaxed);
+		return total;
+	};
+
+	frontier = reached = 1 + close(goal, 0);
+	for (d = 0; frontier > 0; ++d)
+	{
+		frontier = sweep(active, (d + 1) % 3, frontier > n - reached);
+		frontier += close(free, (d + 1) % 3);
+		reached += frontier;
+	}
+	maxDepth = d - 1;
+	data.resize(words);
+	for (i = 0; i < words; ++i)
+		data[i] = cell[i].load(std::memory_order_relaxed);
+}
+
+// Layout: magic, version, pattern name, move, goal and free masks, index
+// count, depth, packed words.
+bool pruningTable::save(const std::string& path) const
+{
+	std::ofstream out(path, std::ios::binary);
+	std::string name = coord.name();
+	uint32_t length = (uint32_t)name.size();
+	uint64_t n = size();
+	int32_t depth = maxDepth;
+	if (!out || data.empty())
+		return false;
+	out.write((const char*)&fileMagic, sizeof(fileMagic));
+	out.write((const char*)&fileVersion, sizeof(fileVersion));
+	out.write((const char*)&length, sizeof(length));
+	out.write(name.data(), length);
+	out.write((const char*)&moveMask, sizeof(moveMask));
+	out.write((const char*)&goalMask, sizeof(goalMask));
+	out.write((const char*)&freeMask, sizeof(freeMask));
+	out.write((const char*)&n, sizeof(n));
+	out.write((const char*)&depth, sizeof(depth));
+	out.write((const char*)data.data(), data.size() * sizeof(uint64_t));
+	return (bool)out;
+}
+bool pruningTable::load(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::string name;
+	uint32_t magic = 0, version = 0, length = 0;
+	uint64_t n = 0, moves = 0, goals = 0, frees = 0;
+	int32_t depth = 0;
+	in.read((char*)&magic, sizeof(magic));
+	in.read((char*)&version, sizeof(version));
+	in.read((char*)&length, sizeof(length));
+	if (!in || magic != fileMagic || version != fileVersion || length > 4096)
+		return false;
+	name.resize(length);
+	in.read(&name[0], length);
+	in.read((char*)&moves, sizeof(moves));
+	in.read((char*)&goals, sizeof(goals));
+	in.read((char*)&frees, sizeof(frees));
+	in.read((char*)&n, sizeof(n));
+	in.read((char*)&depth, sizeof(depth));
+	if (!in || name != coord.name() || moves != moveMask || goals != goalMask || frees != freeMask || n != size())
+		return false;
+	data.resize((n + 31) / 32);
+	in.read((char*)data.data(), data.size() * sizeof(uint64_t));
+	if (!in)
+	{
+		data.clear();
+		return false;
+	}
+	maxDepth = depth;
+	return true;
+}
+
+std::vector<std::string> defaultPatterns()
+{
+	return {
+		"0",
+		"2:5,6,7,8,18,20",
+		"2:22,24,33,34,35,36",
+		"1:1,2,3,4,9,10",
+		"1:11,12,13,14,15,16",
+		"1:25,26,27,28,29,30",
+		"1:31,32,37,38,39,40" };
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "moves.h"
+#include "orbit.h"
+#include "symmetry.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Move distance to a goal for every index of a pattern coordinate, stored as
+// the distance mod 3 in two bits (3 marks an index never reached). Exact
+// distances come from walking down to the goal, or during a search from the
+// parent's distance, since one move changes it by at most one.
+//
+// The distance counts only the moves in moveMask. The goal is solved, or,
+// with a goal mask, every index those moves reach from solved, which makes
+// the table a bound on the distance into the subgroup they generate.
+//
+// Moves in freeMask cost nothing, so the distance counts only the others.
+// Tables that split the moves between them this way can be added and stay
+// admissible; a free move never changes the distance.
+//
+// A reduced table is indexed by a symmetryCoord and so keeps one entry per
+// symmetry class of the pattern.
+class pruningTable
+{
+private:
+	patternCoord coord;
+	std::shared_ptr<const symmetryCoord> sym;
+	uint64_t moveMask;
+	uint64_t goalMask;
+	uint64_t freeMask;
+	std::vector<int> active;
+	std::vector<int> free;
+	uint64_t activeMask;
+	std::vector<uint64_t> data;
+	uint64_t solvedIndex;
+	int maxDepth;
+	uint64_t index(const octaState& s) const
+	{
+		return sym ? sym->rank(s) : coord.rank(s);
+	}
+	void state(uint64_t i, octaState& s) const
+	{
+		if (sym)
+			sym->unrank(i, s);
+		else
+			coord.unrank(i, s);
+	}
+public:
+	explicit pruningTable(const patternCoord& c, uint64_t moveMask = allMoves, uint64_t goalMask = 0, uint64_t freeMask = 0, bool reduced = false);
+	const patternCoord& pattern() const
+	{
+		return coord;
+	}
+	uint64_t moveSet() const
+	{
+		return moveMask;
+	}
+	uint64_t goalSet() const
+	{
+		return goalMask;
+	}
+	uint64_t freeSet() const
+	{
+		return freeMask;
+	}
+	bool reduced() const
+	{
+		return sym != nullptr;
+	}
+	uint64_t size() const
+	{
+		return sym ? sym->size() : coord.size();
+	}
+	int depth() const
+	{
+		return maxDepth;
+	}
+	// Whether move m can change this table's distance at all.
+	bool affects(int m) const
+	{
+		return activeMask >> m & 1;
+	}
+	int get(uint64_t i) const
+	{
+		return (int)(data[i >> 5] >> (i & 31) * 2 & 3);
+	}
+	int distance(const octaState& s) const;
+	int next(int d, const octaState& s) const;
+	std::string fileName() const;
+	// Level-synchronous BFS over all cores (threads == 0) or the given count.
+	void generate(int threads = 0);
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+};
+
+std::vector<std::string> defaultPatterns();
@@ -0,0 +1,51 @@
+#include "rotation.h"
+
+rotationGroup::rotationGroup()
+{
+	int i, j, k;
+	for (i = 0; i < 24; ++i)
+	{
+		mat[i] = glm::mat4(1.0f);
+		for (j = 0; j < 3; ++j)
+			for (k = 0; k < 3; ++k)
+				mat[i][k][j] = (float)entry(i, j, k);
+	}
+}
+const rotationGroup& rotationGroup::get()
+{
+	static const rotationGroup group;
+	return group;
+}
+int rotationGroup::find(const int r[3][3]) const
+{
+	int a, i, j;
+	for (a = 0; a < 24; ++a)
+	{
+		for (i = 0; i < 3; ++i)
+		{
+			for (j = 0; j < 3 && r[i][j] == entry(a, i, j); ++j);
+			if (j < 3)
+				break;
+		}
+		if (i == 3)
+			return a;
+	}
+	return -1;
+}
+// Positive turn about (x, y, z): 120 degrees for a face axis (+-1, +-1, +-1),
+// 90 degrees for a coordinate axis.
+int rotationGroup::turn(int x, int y, int z) const
+{
+	const int a[3] = { x, y, z };
+	int r[3][3] = { { 0, -z, y }, { z, 0, -x }, { -y, x, 0 } };
+	int i, j;
+	for (i = 0; i < 3; ++i)
+		for (j = 0; j < 3; ++j)
+		{
+			if (x * y * z != 0)
+				r[i][j] = (r[i][j] + a[i] * a[j] - (i == j)) / 2;
+			else
+				r[i][j] += a[i] * a[j];
+		}
+	return find(r);
+}
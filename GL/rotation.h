@@ -0,0 +1,122 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// The 24 proper rotations of the octahedron. Every turn the puzzle supports is
+// one of them, so a piece orientation is an index into this table. They are
+// kept as signed permutation matrices:
+// row i of rotation r has its one nonzero entry, sign[r][i], in column
+// col[r][i]. The elements are numbered in the order two generators reach
+// them breadth first, and the Cayley table is built with them at compile
+// time.
+struct rotationTable
+{
+	signed char col[24][3];
+	signed char sign[24][3];
+	unsigned char product[24][24];
+	unsigned char inverse[24];
+};
+constexpr rotationTable makeRotationTable()
+{
+	rotationTable t{};
+	const signed char genCol[2][3] = { { 1, 0, 2 }, { 2, 0, 1 } };
+	const signed char genSign[2][3] = { { -1, 1, 1 }, { 1, 1, 1 } };
+	signed char c[3] = {}, s[3] = {};
+	int i = 0, j = 0, k = 0, r = 0, n = 1;
+	bool same = false;
+	for (r = 0; r < 3; ++r)
+	{
+		t.col[0][r] = (signed char)r;
+		t.sign[0][r] = 1;
+	}
+	for (i = 0; i < n; ++i)
+		for (j = 0; j < 2; ++j)
+		{
+			for (r = 0; r < 3; ++r)
+			{
+				c[r] = t.col[i][genCol[j][r]];
+				s[r] = (signed char)(genSign[j][r] * t.sign[i][genCol[j][r]]);
+			}
+			for (k = 0; k < n; ++k)
+			{
+				same = true;
+				for (r = 0; r < 3; ++r)
+					same = same && c[r] == t.col[k][r] && s[r] == t.sign[k][r];
+				if (same)
+					break;
+			}
+			if (k < n)
+				continue;
+			for (r = 0; r < 3; ++r)
+			{
+				t.col[n][r] = c[r];
+				t.sign[n][r] = s[r];
+			}
+			++n;
+		}
+	for (i = 0; i < 24; ++i)
+		for (j = 0; j < 24; ++j)
+		{
+			for (r = 0; r < 3; ++r)
+			{
+				c[r] = t.col[j][t.col[i][r]];
+				s[r] = (signed char)(t.sign[i][r] * t.sign[j][t.col[i][r]]);
+			}
+			for (k = 0; k < 24; ++k)
+			{
+				same = true;
+				for (r = 0; r < 3; ++r)
+					same = same && c[r] == t.col[k][r] && s[r] == t.sign[k][r];
+				if (same)
+					break;
+			}
+			t.product[i][j] = (unsigned char)k;
+			if (k == 0)
+				t.inverse[i] = (unsigned char)j;
+		}
+	return t;
+}
+// Every product is one of the 24 elements and every element has an inverse.
+constexpr bool isGroup(const rotationTable& t)
+{
+	int a = 0, b = 0;
+	for (a = 0; a < 24; ++a)
+	{
+		if (t.product[a][t.inverse[a]] != 0 || t.product[t.inverse[a]][a] != 0)
+			return false;
+		for (b = 0; b < 24; ++b)
+			if (t.product[a][b] >= 24)
+				return false;
+	}
+	return true;
+}
+constexpr rotationTable rotations = makeRotationTable();
+static_assert(isGroup(rotations), "rotation group does not close");
+
+// The group with the exact float matrices the renderer uses, built once from
+// the table.
+class rotationGroup
+{
+private:
+	glm::mat4 mat[24];
+	rotationGroup();
+public:
+	static const rotationGroup& get();
+	int mul(int a, int b) const
+	{
+		return rotations.product[a][b];
+	}
+	int inv(int a) const
+	{
+		return rotations.inverse[a];
+	}
+	int entry(int a, int i, int j) const
+	{
+		return rotations.col[a][i] == j ? rotations.sign[a][i] : 0;
+	}
+	const glm::mat4& matrix(int a) const
+	{
+		return mat[a];
+	}
+	int find(const int r[3][3]) const;
+	int turn(int x, int y, int z) const;
+};
@@ -0,0 +1,77 @@
+#include "scramble.h"
+
+#include <utility>
+
+scrambler::scrambler(uint64_t seed)
+	: rng(seed)
+{
+}
+// Permutation parity of orbit o, from the number of even-length cycles.
+int scrambler::parity(const octaState& s, int o) const
+{
+	const orbitTable& t = orbitTable::get();
+	const orbitInfo& info = t.orbit(o);
+	bool seen[24] = { false };
+	int i, j, n, p = 0;
+	for (i = 0; i < info.size; ++i)
+	{
+		for (j = i, n = 0; !seen[j]; j = t.indexOfSlot(s.pos[info.slot[j]]), ++n)
+			seen[j] = true;
+		p ^= n > 0 && n % 2 == 0;
+	}
+	return p;
+}
+// Swaps the pieces in the first two slots of orbit o, each keeping its digit.
+void scrambler::swapPieces(octaState& s, int o) const
+{
+	const orbitTable& t = orbitTable::get();
+	int a = t.orbit(o).slot[0], b = t.orbit(o).slot[1];
+	int pa = s.pos[a], pb = s.pos[b], da = t.digit(s, a), db = t.digit(s, b);
+	s.pos[a] = pb;
+	s.ori[a] = t.rotation(a, pb, db);
+	s.pos[b] = pa;
+	s.ori[b] = t.rotation(b, pa, da);
+}
+octaState scrambler::next()
+{
+	const orbitTable& t = orbitTable::get();
+	octaState s;
+	int piece[24], d[24];
+	int i, o, n, last, sum;
+	for (o = 0; o < t.orbits(); ++o)
+	{
+		const orbitInfo& info = t.orbit(o);
+		n = info.size;
+		for (i = 0; i < n; ++i)
+			piece[i] = info.slot[i];
+		for (i = n - 1; i > 0; --i)
+			std::swap(piece[i], piece[std::uniform_int_distribution<int>(0, i)(rng)]);
+		for (sum = 0, i = 0; i < n; ++i)
+		{
+			d[i] = std::uniform_int_distribution<int>(0, info.twists - 1)(rng);
+			sum += d[i];
+		}
+		if (info.twistSum)
+			d[n - 1] = ((d[n - 1] - sum) % info.twists + info.twists) % info.twists;
+		for (i = 0; i < n; ++i)
+		{
+			s.pos[info.slot[i]] = piece[i];
+			s.ori[info.slot[i]] = t.rotation(info.slot[i], piece[i], d[i]);
+		}
+		if (info.evenOnly && parity(s, o))
+			swapPieces(s, o);
+	}
+	for (i = 0; i < t.parityRuleCount(); ++i)
+	{
+		for (sum = 0, last = -1, o = 0; o < t.orbits(); ++o)
+			if (t.parityMask(i) >> o & 1)
+			{
+				sum ^= parity(s, o);
+				if (!t.orbit(o).evenOnly)
+					last = o;
+			}
+		if (sum && last >= 0)
+			swapPieces(s, last);
+	}
+	return s;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "orbit.h"
+
+#include <cstdint>
+#include <random>
+
+// Uniformly random reachable states. Each orbit gets a uniform permutation
+// and uniform orientation digits, with the last digit fixed when the orbit's
+// twists must sum to zero. A parity constraint that comes out odd is repaired
+// by swapping two pieces of one of its orbits, which pairs the odd draws one
+// to one with the even ones.
+class scrambler
+{
+private:
+	std::mt19937_64 rng;
+	int parity(const octaState& s, int o) const;
+	void swapPieces(octaState& s, int o) const;
+public:
+	explicit scrambler(uint64_t seed);
+	octaState next();
+};
@@ -0,0 +1,58 @@
+#include "sequence.h"
+#include "moves.h"
+#include "rotation.h"
+
+void applyTransform(const octaState& t, const octaState& a, octaState& b)
+{
+	const rotationGroup& g = rotationGroup::get();
+	int i;
+	for (i = 0; i < 42; ++i)
+	{
+		b.pos[i] = a.pos[t.pos[i]];
+		b.ori[i] = g.mul(t.ori[i], a.ori[t.pos[i]]);
+	}
+}
+octaState invertTransform(const octaState& t)
+{
+	const rotationGroup& g = rotationGroup::get();
+	octaState r;
+	int i;
+	for (i = 0; i < 42; ++i)
+	{
+		r.pos[t.pos[i]] = i;
+		r.ori[t.pos[i]] = g.inv(t.ori[i]);
+	}
+	return r;
+}
+octaState compileSequence(const int* seq, int n)
+{
+	octaState a, b;
+	int i;
+	for (i = 0; i + 1 < n; i += 2)
+	{
+		applyMove(a, seq[i], b);
+		applyMove(b, seq[i + 1], a);
+	}
+	if (i < n)
+		applyMove(a, seq[i]);
+	return a;
+}
+
+octaState sequenceCache::get(const std::vector<int>& seq)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	auto it = cache.find(seq);
+	if (it == cache.end())
+		it = cache.emplace(seq, compileSequence(seq)).first;
+	return it->second;
+}
+size_t sequenceCache::size()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return cache.size();
+}
+void sequenceCache::clear()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	cache.clear();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "octaState.h"
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// A move sequence fused into one transform. The transform is the state the
+// sequence produces from solved, so applying it is a single gather no matter
+// how long the sequence was, and two transforms compose the same way.
+void applyTransform(const octaState& t, const octaState& a, octaState& b);
+inline void applyTransform(const octaState& t, octaState& s)
+{
+	octaState a = s;
+	applyTransform(t, a, s);
+}
+octaState invertTransform(const octaState& t);
+octaState compileSequence(const int* seq, int n);
+inline octaState compileSequence(const std::vector<int>& seq)
+{
+	return compileSequence(seq.data(), (int)seq.size());
+}
+
+struct sequenceHash
+{
+	size_t operator()(const std::vector<int>& seq) const
+	{
+		size_t h = 0;
+		for (int m : seq)
+			h = h * 131 + m + 1;
+		return h;
+	}
+};
+// Compiled transforms keyed by sequence, shared between threads.
+class sequenceCache
+{
+private:
+	std::mutex lock;
+	std::unordered_map<std::vector<int>, octaState, sequenceHash> cache;
+public:
+	// Returns a copy: a reference into the map would not survive a clear() from
+	// another thread.
+	octaState get(const std::vector<int>& seq);
+	size_t size();
+	void clear();
+};
@@ -0,0 +1,256 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	struct workQueue
+	{
+		std::mutex lock;
+		std::deque<int> items;
+	};
+
+	// Owners take their lowest task first; thieves take the highest.
+	int takeTask(std::vector<workQueue>& queues, int self)
+	{
+		int i, v, n = (int)queues.size();
+		for (i = 0; i < n; ++i)
+		{
+			workQueue& q = queues[(self + i) % n];
+			std::lock_guard<std::mutex> hold(q.lock);
+			if (q.items.empty())
+				continue;
+			if (i == 0)
+			{
+				v = q.items.front();
+				q.items.pop_front();
+			}
+			else
+			{
+				v = q.items.back();
+				q.items.pop_back();
+			}
+			return v;
+		}
+		return -1;
+	}
+}
+
+void pruningSet::load(pruningTable& table, const std::string& dir)
+{
+	std::string path = dir + table.fileName();
+	if (!table.load(path))
+	{
+		table.generate();
+		table.save(path);
+	}
+}
+void pruningSet::add(const std::string& spec, const std::string& dir, uint64_t moveMask, uint64_t goalMask, bool reduced)
+{
+	pruningTable table(patternCoord(spec), moveMask, goalMask, 0, reduced);
+	load(table, dir);
+	tables.push_back(std::move(table));
+	ends.push_back((int)tables.size());
+}
+void pruningSet::addGroup(const std::vector<std::string>& specs, const std::string& dir, uint64_t moveMask, std::vector<uint64_t> counted, bool reduced)
+{
+	std::vector<patternCoord> coords;
+	std::vector<int> owned(specs.size(), 0);
+	const uint64_t evenMoves = 0x5555555555ull;
+	uint64_t seen = 0;
+	size_t i, best;
+	int m;
+	for (i = 0; i < specs.size(); ++i)
+		coords.push_back(patternCoord(specs[i]));
+	if (!counted.empty())
+	{
+		if (counted.size() != specs.size())
+			throw std::invalid_argument("one move mask per pattern is needed");
+		for (i = 0; i < counted.size(); ++i)
+		{
+			if ((counted[i] & evenMoves) != (counted[i] >> 1 & evenMoves))
+				throw std::invalid_argument("a move and its inverse are counted apart");
+			if (counted[i] & ~moveMask)
+				throw std::invalid_argument("a counted move is not in the move set");
+			if (counted[i] & seen)
+				throw std::invalid_argument("additive tables count the same move");
+			seen |= counted[i];
+		}
+	}
+	else
+		counted.assign(specs.size(), 0);
+	for (m = 0; m < moveCount && !seen; m += 2)
+	{
+		if (!(moveMask >> m & 1))
+			continue;
+		for (best = specs.size(), i = 0; i < specs.size(); ++i)
+			if (coords[i].touches(m) && (best == specs.size() || owned[i] < owned[best]))
+				best = i;
+		if (best == specs.size())
+			continue;
+		counted[best] |= 3ull << m;
+		++owned[best];
+	}
+	for (i = 0; i < specs.size(); ++i)
+	{
+		pruningTable table(coords[i], moveMask, 0, moveMask & ~counted[i], reduced);
+		load(table, dir);
+		tables.push_back(std::move(table));
+	}
+	ends.push_back((int)tables.size());
+}
+int pruningSet::estimate(const octaState& s, int* dist) const
+{
+	int i, g, sum, h = 0;
+	for (i = 0, g = 0; g < (int)ends.size(); ++g)
+	{
+		for (sum = 0; i < ends[g]; ++i)
+		{
+			dist[i] = tables[i].distance(s);
+			if (dist[i] < 0)
+				return -1;
+			sum += dist[i];
+		}
+		h = std::max(h, sum);
+	}
+	return h;
+}
+bool pruningSet::update(const int* dist, int m, const octaState& t, int limit, int* next) const
+{
+	int i, g, sum;
+	for (i = 0, g = 0; g < (int)ends.size(); ++g)
+		for (sum = 0; i < ends[g]; ++i)
+		{
+			next[i] = tables[i].affects(m) ? tables[i].next(dist[i], t) : dist[i];
+			sum += next[i];
+			if (sum > limit)
+				return false;
+		}
+	return true;
+}
+
+// std::min binds it to a reference, so it needs a definition.
+const int optimalSolver::splitDepth;
+
+optimalSolver::optimalSolver(const pruningSet& h, int threads, bool deterministic, uint64_t moveMask)
+	: tables(h), canon(moveAutomaton::get(moveMask)), group(moveMask), threads(threads), deterministic(deterministic), nodes(0)
+{
+	if (tables.size() > maxTables)
+		throw std::invalid_argument("too many pruning tables");
+	if (this->threads <= 0)
+		this->threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Applies m and fills in the child's distances, giving up as soon as one
+// table puts it past the bound.
+bool optimalSolver::expand(const octaState& s, const int* dist, int m, int g, int bound, octaState& t, int* next) const
+{
+	applyMove(s, m, t);
+	return tables.update(dist, m, t, bound - g - 1, next);
+}
+// Collects the subtrees at the split depth in the order a single-threaded
+// search would visit them.
+void optimalSolver::split(const octaState& s, const int* dist, int node, int* path, int g, int depth, int bound)
+{
+	octaState t;
+	int next[maxTables];
+	int m, after;
+	if (g == depth)
+	{
+		roots.push_back(subtree());
+		roots.back().state = s;
+		roots.back().node = node;
+		std::copy(dist, dist + tables.size(), roots.back().dist);
+		std::copy(path, path + g, roots.back().path);
+		return;
+	}
+	for (m = 0; m < moveCount; ++m)
+		if ((after = canon.next(node, m)) >= 0 && expand(s, dist, m, g, bound, t, next))
+		{
+			path[g] = m;
+			split(t, next, after, path, g + 1, depth, bound);
+		}
+}
+bool optimalSolver::search(worker& w, const octaState& s, const int* dist, int node, int g, int bound)
+{
+	octaState t;
+	int next[maxTables];
+	int i, m, after, mine;
+	bool done = true;
+	if (found.load(std::memory_order_relaxed) < w.task)
+		return false;
+	for (i = 0; i < tables.size(); ++i)
+		done &= dist[i] == 0;
+	if (done && s.solved())
+	{
+		std::lock_guard<std::mutex> hold(resultLock);
+		mine = deterministic ? w.task : -1;
+		if (mine < found.load())
+		{
+			found = mine;
+			result.assign(w.path, w.path + g);
+		}
+		return true;
+	}
+	if (g == bound || g == maxDepth)
+		return false;
+	++w.nodes;
+	for (m = 0; m < moveCount; ++m)
+		if ((after = canon.next(node, m)) >= 0 && expand(s, dist, m, g, bound, t, next))
+		{
+			w.path[g] = m;
+			if (search(w, t, next, after, g + 1, bound))
+				return true;
+		}
+	return false;
+}
+void optimalSolver::run(int bound)
+{
+	std::vector<workQueue> queues(threads);
+	std::vector<std::thread> pool;
+	std::vector<uint64_t> counts(threads, 0);
+	int i, depth = std::min(splitDepth, bound);
+	auto work = [&](int self)
+	{
+		worker w;
+		w.nodes = 0;
+		while ((w.task = takeTask(queues, self)) >= 0)
+		{
+			std::copy(roots[w.task].path, roots[w.task].path + depth, w.path);
+			search(w, roots[w.task].state, roots[w.task].dist, roots[w.task].node, depth, bound);
+		}
+		counts[self] = w.nodes;
+	};
+	for (i = 0; i < (int)roots.size(); ++i)
+		queues[(size_t)i * threads / roots.size()].items.push_back(i);
+	for (i = 1; i < threads; ++i)
+		pool.push_back(std::thread(work, i));
+	work(0);
+	for (i = 0; i < (int)pool.size(); ++i)
+		pool[i].join();
+	for (i = 0; i < threads; ++i)
+		nodes += counts[i];
+}
+std::vector<int> optimalSolver::solve(const octaState& s)
+{
+	int dist[maxTables], path[splitDepth];
+	int bound;
+	nodes = 0;
+	if (!group.contains(s) || (bound = tables.estimate(s, dist)) < 0)
+		throw std::invalid_argument("state is not reachable");
+	found = INT_MAX;
+	result.clear();
+	for (; bound <= maxDepth; ++bound)
+	{
+		roots.clear();
+		split(s, dist, moveAutomaton::start, path, 0, std::min(splitDepth, bound), bound);
+		run(bound);
+		if (found != INT_MAX)
+			return result;
+	}
+	throw std::runtime_error("no solution within the depth limit");
+}
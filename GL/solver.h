@@ -0,0 +1,98 @@
+#pragma once
+#include "automaton.h"
+#include "moves.h"
+#include "pruning.h"
+#include "stabilizer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// The pruning tables a search uses, in groups whose distances are added; the
+// heuristic is the largest group sum, which stays admissible as long as the
+// tables of a group count disjoint sets of moves. A table added on its own
+// is a group of one.
+class pruningSet
+{
+private:
+	std::vector<pruningTable> tables;
+	std::vector<int> ends;
+	void load(pruningTable& table, const std::string& dir);
+public:
+	// Loads the pattern's table from dir, generating and saving it if the file
+	// is missing or stale. A reduced table keeps one entry per symmetry class.
+	void add(const std::string& spec, const std::string& dir, uint64_t moveMask = allMoves, uint64_t goalMask = 0, bool reduced = false);
+	// Adds the patterns as one additive group over the moves in moveMask,
+	// table i counting the moves in counted[i] and the others free; the masks
+	// must be disjoint. Without masks each inverse pair of moves is counted by
+	// one of the tables it touches, the one with the fewest so far.
+	void addGroup(const std::vector<std::string>& specs, const std::string& dir, uint64_t moveMask = allMoves, std::vector<uint64_t> counted = {}, bool reduced = false);
+	int size() const
+	{
+		return (int)tables.size();
+	}
+	const pruningTable& table(int i) const
+	{
+		return tables[i];
+	}
+	// Exact distances of s and the heuristic, or -1 if a table never reaches s.
+	int estimate(const octaState& s, int* dist) const;
+	// Distances of t, one move m away from a state at dist. Gives up with
+	// false as soon as the heuristic is past limit.
+	bool update(const int* dist, int m, const octaState& t, int limit, int* next) const;
+};
+
+// Iterative-deepening A* over canonical sequences of a move set, all 40 moves
+// by default; tables built for the same set give it the subgroup's own
+// distances. States outside the subgroup are refused up front. Each node
+// carries the exact distance of every table, updated from its parent's in
+// one lookup.
+//
+// Every iteration is cut into the subtrees below a shallow split depth and
+// run on a work-stealing pool. Once a worker finds a solution the others
+// stop; in deterministic mode only later subtrees stop, so the result is the
+// one a single thread would return.
+class optimalSolver
+{
+private:
+	static const int maxTables = 16;
+	static const int maxDepth = 64;
+	static const int splitDepth = 2;
+	struct subtree
+	{
+		octaState state;
+		int node;
+		int dist[maxTables];
+		int path[splitDepth];
+	};
+	struct worker
+	{
+		int path[maxDepth];
+		int task;
+		uint64_t nodes;
+	};
+	const pruningSet& tables;
+	const moveAutomaton& canon;
+	stabilizerChain group;
+	int threads;
+	bool deterministic;
+	std::vector<subtree> roots;
+	std::atomic<int> found;
+	std::mutex resultLock;
+	std::vector<int> result;
+	uint64_t nodes;
+	bool expand(const octaState& s, const int* dist, int m, int g, int bound, octaState& t, int* next) const;
+	void split(const octaState& s, const int* dist, int node, int* path, int g, int depth, int bound);
+	bool search(worker& w, const octaState& s, const int* dist, int node, int g, int bound);
+	void run(int bound);
+public:
+	// threads == 0 uses every core.
+	explicit optimalSolver(const pruningSet& h, int threads = 1, bool deterministic = false, uint64_t moveMask = allMoves);
+	std::vector<int> solve(const octaState& s);
+	uint64_t expanded() const
+	{
+		return nodes;
+	}
+};
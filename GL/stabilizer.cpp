@@ -0,0 +1,170 @@
+#include "stabilizer.h"
+#include "orbit.h"
+
+#include <stdexcept>
+
+namespace
+{
+	typedef stabilizerChain::perm perm;
+
+	// a after b.
+	perm compose(const perm& a, const perm& b)
+	{
+		perm c;
+		int i;
+		for (i = 0; i < stabilizerChain::points; ++i)
+			c[i] = a[b[i]];
+		return c;
+	}
+	perm invert(const perm& a)
+	{
+		perm c;
+		int i;
+		for (i = 0; i < stabilizerChain::points; ++i)
+			c[a[i]] = (unsigned char)i;
+		return c;
+	}
+}
+
+stabilizerChain::stabilizerChain(uint64_t moveMask)
+{
+	const orbitTable& orbits = orbitTable::get();
+	octaState s;
+	perm g;
+	int i, x, m, n = 0;
+	for (x = 0; x < 42; ++x)
+	{
+		firstPoint[x] = n;
+		twists[x] = orbits.orbit(orbits.orbitOfSlot(x)).twists;
+		n += twists[x];
+	}
+	if (n != points)
+		throw std::logic_error("orbit digits do not give 72 points");
+	for (i = 0; i < points; ++i)
+	{
+		trans[i].resize(points);
+		inverse[i].resize(points);
+		reached[i].assign(points, false);
+		reached[i][i] = true;
+		for (x = 0; x < points; ++x)
+			trans[i][i][x] = inverse[i][i][x] = (unsigned char)x;
+	}
+	for (m = 0; m < moveCount; ++m)
+		if (moveMask >> m & 1)
+		{
+			s.reset();
+			applyMove(s, m);
+			toPerm(s, g);
+			if (!sift(0, g))
+				addGenerator(0, g);
+		}
+}
+
+bool stabilizerChain::toPerm(const octaState& s, perm& g) const
+{
+	const orbitTable& orbits = orbitTable::get();
+	bool used[42] = {};
+	int x, y, d, e;
+	for (y = 0; y < 42; ++y)
+	{
+		x = s.pos[y];
+		if (x >= 42 || used[x] || orbits.orbitOfSlot(x) != orbits.orbitOfSlot(y) || (e = orbits.digit(s, y)) < 0)
+			return false;
+		used[x] = true;
+		for (d = 0; d < twists[x]; ++d)
+			g[firstPoint[x] + d] = (unsigned char)(firstPoint[y] + (d + e) % twists[y]);
+	}
+	return true;
+}
+// Points before i are already fixed, so only the rest is composed.
+bool stabilizerChain::sift(int i, perm g) const
+{
+	const unsigned char* u;
+	int p, j;
+	for (; i < points; ++i)
+	{
+		p = g[i];
+		if (p == i)
+			continue;
+		if (!reached[i][p])
+			return false;
+		u = inverse[i][p].data();
+		for (j = i + 1; j < points; ++j)
+			g[j] = u[g[j]];
+	}
+	return true;
+}
+bool stabilizerChain::contains(const octaState& s) const
+{
+	perm g;
+	return toPerm(s, g) && sift(0, g);
+}
+
+// Incremental Schreier-Sims: h joins level i's orbit if it carries i somewhere
+// new, and otherwise its Schreier generator is sifted into level i + 1.
+void stabilizerChain::extend(int i, const perm& h)
+{
+	perm r;
+	size_t k;
+	int p = h[i];
+	if (reached[i][p])
+	{
+		r = compose(inverse[i][p], h);
+		if (!sift(i + 1, r))
+			addGenerator(i + 1, r);
+		return;
+	}
+	reached[i][p] = true;
+	trans[i][p] = h;
+	inverse[i][p] = invert(h);
+	for (k = 0; k < gens[i].size(); ++k)
+		extend(i, compose(gens[i][k], h));
+}
+void stabilizerChain::addGenerator(int i, const perm& g)
+{
+	std::vector<int> known;
+	size_t k;
+	int p;
+	gens[i].push_back(g);
+	for (p = 0; p < points; ++p)
+		if (reached[i][p])
+			known.push_back(p);
+	for (k = 0; k < known.size(); ++k)
+		extend(i, compose(g, trans[i][known[k]]));
+}
+
+int stabilizerChain::orbitSize(int i) const
+{
+	int p, n = 0;
+	for (p = 0; p < points; ++p)
+		n += reached[i][p];
+	return n;
+}
+// The product of the orbit sizes from level from on, in base 10^9 limbs.
+std::string stabilizerChain::product(int from) const
+{
+	std::vector<uint32_t> limb(1, 1);
+	std::string text, part;
+	uint64_t carry;
+	size_t k;
+	int i;
+	for (i = from; i < points; ++i)
+	{
+		carry = 0;
+		for (k = 0; k < limb.size(); ++k)
+		{
+			carry += (uint64_t)limb[k] * orbitSize(i);
+			limb[k] = (uint32_t)(carry % 1000000000);
+			carry /= 1000000000;
+		}
+		if (carry)
+			limb.push_back((uint32_t)carry);
+	}
+	text = std::to_string(limb.back());
+	for (k = limb.size() - 1; k-- > 0;)
+	{
+		part = std::to_string(limb[k]);
+		text += std::string(9 - part.size(), '0') + part;
+	}
+	return text;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "moves.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Schreier-Sims stabilizer chain of the group generated by a move set. The
+// group acts on 72 points, one per slot and orientation digit, and a state
+// is the permutation taking each piece's home point to where it now sits.
+// The base is the points in order: level i keeps, for every point the
+// stabilizer of points 0..i-1 can carry i to, one element doing so.
+//
+// Membership sifts a state down the chain, one composition per level that
+// moves its base point, so it costs at most 72 * 72 steps.
+class stabilizerChain
+{
+public:
+	static const int points = 72;
+	typedef std::array<unsigned char, points> perm;
+private:
+	int firstPoint[42];
+	int twists[42];
+	std::vector<perm> gens[points];
+	std::vector<perm> trans[points];
+	std::vector<perm> inverse[points];
+	std::vector<bool> reached[points];
+	bool sift(int i, perm g) const;
+	void extend(int i, const perm& h);
+	void addGenerator(int i, const perm& g);
+	std::string product(int from) const;
+public:
+	explicit stabilizerChain(uint64_t moveMask = allMoves);
+	// False when s is not even a placement of the pieces in their orbits.
+	bool toPerm(const octaState& s, perm& g) const;
+	bool contains(const octaState& s) const;
+	// Decimal group order.
+	std::string order() const
+	{
+		return product(0);
+	}
+	// Size of the orbit of base point i under the stabilizer of the points
+	// before it, and the order of that stabilizer.
+	int orbitSize(int i) const;
+	std::string stabilizerOrder(int i) const
+	{
+		return product(i);
+	}
+};
@@ -0,0 +1,230 @@
+#include "symmetry.h"
+#include "rotation.h"
+
+#include <stdexcept>
+
+symmetryTable::symmetryTable()
+{
+	const int order[6][3] = { {0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0} };
+	int p, signs, i, j, k, a;
+	count = 0;
+	for (p = 0; p < 6; ++p)
+		for (signs = 0; signs < 8; ++signs)
+		{
+			for (i = 0; i < 3; ++i)
+				for (j = 0; j < 3; ++j)
+					mat[count][i][j] = j == order[p][i] ? (signs >> i & 1 ? -1 : 1) : 0;
+			if (build(count))
+				++count;
+		}
+	for (k = 0; k < count; ++k)
+		for (a = 0; a < count; ++a)
+		{
+			for (i = 0; i < 9 && mat[a][i / 3][i % 3] == mat[k][i % 3][i / 3]; ++i);
+			if (i == 9)
+				inverse[k] = (unsigned char)a;
+		}
+}
+// Fills in the rotation, move and slot maps of matrix k; false if the move
+// tables do not agree with it.
+bool symmetryTable::build(int k)
+{
+	const rotationGroup& g = rotationGroup::get();
+	const orbitTable& t = orbitTable::get();
+	int (&s)[3][3] = mat[k];
+	int image[42], c[3][3], b[3];
+	bool used[42], ok;
+	int a, i, j, n, m, q, r, o, det, stack[42];
+	const int* u;
+	det = s[0][0] * (s[1][1] * s[2][2] - s[1][2] * s[2][1])
+		- s[0][1] * (s[1][0] * s[2][2] - s[1][2] * s[2][0])
+		+ s[0][2] * (s[1][0] * s[2][1] - s[1][1] * s[2][0]);
+	for (a = 0; a < 24; ++a)
+	{
+		for (i = 0; i < 3; ++i)
+			for (j = 0; j < 3; ++j)
+				for (c[i][j] = 0, n = 0; n < 9; ++n)
+					c[i][j] += s[i][n / 3] * g.entry(a, n / 3, n % 3) * s[j][n % 3];
+		if ((r = g.find(c)) < 0)
+			return false;
+		rot[k][a] = (unsigned char)r;
+	}
+	// A reflection turns the image axis the other way.
+	for (m = 0; m < moveCount; ++m)
+	{
+		u = turnAxis[moveId(m) - 1];
+		for (i = 0; i < 3; ++i)
+			b[i] = s[i][0] * u[0] + s[i][1] * u[1] + s[i][2] * u[2];
+		for (r = -1, q = 1; q <= moveCount / 2; ++q)
+			if (turnAxis[q - 1][0] == b[0] && turnAxis[q - 1][1] == b[1] && turnAxis[q - 1][2] == b[2]
+				&& (r < 0 || (q - moveId(m)) % 2 == 0))
+				r = q;
+		if (r < 0)
+			return false;
+		move[k][m] = (unsigned char)moveIndex(r, moveShift(m) * det);
+		if (moveRotation(move[k][m]) != rot[k][moveRotation(m)])
+			return false;
+	}
+	// Each orbit is connected by the moves, so the image of one slot fixes
+	// the rest; try every candidate for it.
+	for (i = 0; i < 42; ++i)
+	{
+		image[i] = -1;
+		used[i] = false;
+	}
+	for (o = 0; o < t.orbits(); ++o)
+	{
+		const orbitInfo& info = t.orbit(o);
+		for (a = 0; a < info.size; ++a)
+		{
+			for (i = 0; i < info.size; ++i)
+			{
+				image[info.slot[i]] = -1;
+				used[info.slot[i]] = false;
+			}
+			image[info.slot[0]] = info.slot[a];
+			used[info.slot[a]] = true;
+			stack[0] = info.slot[0];
+			for (n = 1, ok = true; ok && n > 0;)
+			{
+				i = stack[--n];
+				for (m = 0; ok && m < moveCount; ++m)
+				{
+					j = moves.perm[m][i];
+					r = moves.perm[move[k][m]][image[i]];
+					if (moves.turn[m][i] != moves.turn[move[k][m]][image[i]])
+						ok = false;
+					else if (image[j] < 0 && !used[r])
+					{
+						image[j] = r;
+						used[r] = true;
+						stack[n++] = j;
+					}
+					else if (image[j] != r)
+						ok = false;
+				}
+			}
+			if (ok)
+				break;
+		}
+		if (a == info.size)
+			return false;
+	}
+	for (i = 0; i < 42; ++i)
+		slot[k][i] = (unsigned char)image[i];
+	return true;
+}
+const symmetryTable& symmetryTable::get()
+{
+	static const symmetryTable table;
+	return table;
+}
+uint64_t symmetryTable::mapMoves(int k, uint64_t mask) const
+{
+	uint64_t r = 0;
+	int m;
+	for (m = 0; m < moveCount; ++m)
+		if (mask >> m & 1)
+			r |= 1ull << move[k][m];
+	return r;
+}
+void symmetryTable::conjugate(const octaState& s, int k, octaState& t) const
+{
+	int x;
+	for (x = 0; x < 42; ++x)
+	{
+		t.pos[slot[k][x]] = slot[k][s.pos[x]];
+		t.ori[slot[k][x]] = rot[k][s.ori[x]];
+	}
+}
+
+symmetryCoord::symmetryCoord(const patternCoord& c, uint64_t moveMask, uint64_t goalMask, uint64_t freeMask)
+	: coord(c)
+{
+	const symmetryTable& t = symmetryTable::get();
+	const orbitCoord& first = coord.part(0);
+	octaState a, b;
+	int f[24], size[24], k, p, i, j, g;
+	uint64_t n = first.size(), r, x;
+	for (k = 0; k < t.size(); ++k)
+	{
+		if (t.mapMoves(k, moveMask) != moveMask || t.mapMoves(k, goalMask) != goalMask || t.mapMoves(k, freeMask) != freeMask)
+			continue;
+		// The slots have to map onto themselves and every group onto one group of
+		// the same size.
+		for (p = 0; p < coord.partCount(); ++p)
+		{
+			const orbitCoord& o = coord.part(p);
+			for (g = 0; g < 24; ++g)
+			{
+				f[g] = -1;
+				size[g] = 0;
+			}
+			for (i = 0; i < o.slotCount(); ++i)
+			{
+				for (j = 0; j < o.slotCount() && o.getSlot(j) != t.mapSlot(k, o.getSlot(i)); ++j);
+				if (j == o.slotCount())
+					break;
+			}
+			if (i < o.slotCount())
+				break;
+			for (i = 0; i < o.pieceCount(); ++i)
+				++size[o.pieceGroup(i)];
+			for (i = 0; i < o.pieceCount(); ++i)
+			{
+				for (j = 0; j < o.pieceCount() && o.getPiece(j) != t.mapSlot(k, o.getPiece(i)); ++j);
+				if (j == o.pieceCount())
+					break;
+				g = o.pieceGroup(i);
+				if (f[g] < 0)
+					f[g] = o.pieceGroup(j);
+				if (f[g] != o.pieceGroup(j) || size[g] != size[f[g]])
+					break;
+			}
+			if (i < o.pieceCount())
+				break;
+		}
+		if (p == coord.partCount())
+			syms.push_back(k);
+	}
+	if (n > 1ull << 32)
+		throw std::invalid_argument("first pattern part is too large to reduce");
+	rest = coord.size() / n;
+	classOf.assign(n, ~0u);
+	for (r = 0; r < n; ++r)
+	{
+		if (classOf[r] != ~0u)
+			continue;
+		first.unrank(r, a);
+		for (i = 0; i < (int)syms.size(); ++i)
+		{
+			t.conjugate(a, syms[i], b);
+			x = first.rank(b);
+			if (classOf[x] == ~0u)
+				classOf[x] = (uint32_t)rep.size() << 6 | t.inv(syms[i]);
+		}
+		rep.push_back(r);
+		if (rep.size() > 1 << 26)
+			throw std::invalid_argument("first pattern part has too many classes");
+	}
+}
+uint64_t symmetryCoord::rank(const octaState& s) const
+{
+	uint32_t e = classOf[coord.part(0).rank(s)];
+	uint64_t r = 0;
+	octaState t;
+	const octaState* u = &s;
+	int i;
+	if (e & 63)
+	{
+		symmetryTable::get().conjugate(s, e & 63, t);
+		u = &t;
+	}
+	for (i = 1; i < coord.partCount(); ++i)
+		r = r * coord.part(i).size() + coord.part(i).rank(*u);
+	return (e >> 6) * rest + r;
+}
+void symmetryCoord::unrank(uint64_t r, octaState& s) const
+{
+	coord.unrank(rep[r / rest] * rest + r % rest, s);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "moves.h"
+#include "orbit.h"
+
+#include <cstdint>
+#include <vector>
+
+// Symmetries of the puzzle among the 48 signed permutation matrices. Each
+// maps turn axes onto turn axes, so it maps every move to a move (a
+// reflection reverses the turn), and the positions to positions so that the
+// move tables agree. Conjugating a state by a symmetry moves every piece to
+// the image of its slot and conjugates its rotation:
+//   conjugate(applyMove(s, m), k) == applyMove(conjugate(s, k), mapMove(k, m))
+// Symmetry 0 is the identity.
+class symmetryTable
+{
+private:
+	int count;
+	int mat[48][3][3];
+	unsigned char slot[48][42];
+	unsigned char move[48][moveCount];
+	unsigned char rot[48][24];
+	unsigned char inverse[48];
+	symmetryTable();
+	bool build(int k);
+public:
+	static const symmetryTable& get();
+	int size() const
+	{
+		return count;
+	}
+	int inv(int k) const
+	{
+		return inverse[k];
+	}
+	int mapSlot(int k, int x) const
+	{
+		return slot[k][x];
+	}
+	int mapMove(int k, int m) const
+	{
+		return move[k][m];
+	}
+	uint64_t mapMoves(int k, uint64_t mask) const;
+	void conjugate(const octaState& s, int k, octaState& t) const;
+};
+
+// A pattern coordinate reduced by the symmetries that map its pieces (and
+// groups) and its move, goal and free sets onto themselves, so that
+// distances are the same for a state and its conjugates. The first
+// part is replaced by its class under them: a state is conjugated to bring
+// that part to the class representative, and the other parts are ranked as
+// usual. Tables shrink by about the number of symmetries kept.
+class symmetryCoord
+{
+private:
+	patternCoord coord;
+	std::vector<int> syms;
+	std::vector<uint32_t> classOf;
+	std::vector<uint64_t> rep;
+	uint64_t rest;
+public:
+	symmetryCoord(const patternCoord& c, uint64_t moveMask, uint64_t goalMask, uint64_t freeMask = 0);
+	int symmetries() const
+	{
+		return (int)syms.size();
+	}
+	uint64_t classes() const
+	{
+		return rep.size();
+	}
+	uint64_t size() const
+	{
+		return rep.size() * rest;
+	}
+	uint64_t rank(const octaState& s) const;
+	void unrank(uint64_t r, octaState& s) const;
+};
@@ -0,0 +1,507 @@
+#include "tools.h"
+#include "bidirectional.h"
+#include "census.h"
+#include "finder.h"
+#include "multiPhase.h"
+#include "optimizer.h"
+#include "pruning.h"
+#include "scramble.h"
+#include "sequence.h"
+#include "stabilizer.h"
+#include "solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+static int usage()
+{
+	std::cout << "usage:\n"
+		<< "  GL tables <dir> [-s] [-m set] [pattern...]\n"
+		<< "                                 generate pruning tables into dir\n"
+		<< "  GL solve <dir> [-t threads] [-d] [-s] [-m set] [-a patterns] [-f seconds] [input]\n"
+		<< "                                 solve one state per line (stdin by default);\n"
+		<< "                                 -s uses tables reduced by symmetry,\n"
+		<< "                                 -m only the moves of the set, with its own tables,\n"
+		<< "                                 -a adds the ';'-separated patterns as one\n"
+		<< "                                 additive group to the default tables,\n"
+		<< "                                 -d returns the same solution for any thread count,\n"
+		<< "                                 -f the shortest multi-phase solution found within\n"
+		<< "                                 the seconds given, which is not optimal; it takes\n"
+		<< "                                 none of the other options\n"
+		<< "  GL meet [-t threads] [-c bits] [input]\n"
+		<< "                                 solve one state per line optimally without tables,\n"
+		<< "                                 searching from both ends in a table of 2^bits slots\n"
+		<< "  GL count <pattern> [-m set] [-t threads] [-s shard dir]\n"
+		<< "                                 count the indices at each distance under the\n"
+		<< "                                 move set, keeping shard indices in memory\n"
+		<< "  GL scramble [-n count] [-s seed] [-f dir seconds]\n"
+		<< "                                 print uniformly random states, each followed\n"
+		<< "                                 with -f by a multi-phase sequence reaching it\n"
+		<< "  GL optimize [-w depth] [input]\n"
+		<< "                                 shorten one move sequence per line, solving\n"
+		<< "                                 every window of up to depth + 1 moves\n"
+		<< "  GL find [-w depth] [-l length] [-o] <cycle...>\n"
+		<< "                                 shortest sequence of at most length moves cycling\n"
+		<< "                                 the pieces of each ','-separated slot list, -o\n"
+		<< "                                 in any orientation\n"
+		<< "  GL group [-m set] [input]\n"
+		<< "                                 order and stabilizer chain of the group the move\n"
+		<< "                                 set generates; with input, whether each\n"
+		<< "                                 state is in it\n"
+		<< "patterns are '+'-joined orbit coordinates, e.g. 0 or 2:5,6,7,8+0\n"
+		<< "and '@slot,...' limits a coordinate to those slots, e.g. 1:12@12,13,28,29\n"
+		<< "a move set is all, face, corner or addTask ids and ranges, e.g. 1,3,9-12\n"
+		<< "a state is 84 numbers (formatState) or a move sequence such as 9' 3 14\n";
+	return 1;
+}
+
+static std::string tableDir(const char* arg)
+{
+	std::string dir = arg;
+	if (!dir.empty() && dir.back() != '/' && dir.back() != '\\')
+		dir += '/';
+	return dir;
+}
+
+static int makeTables(int argc, char* argv[])
+{
+	std::vector<std::string> specs;
+	std::string dir;
+	std::chrono::steady_clock::time_point start;
+	uint64_t moves = allMoves;
+	double seconds;
+	int i;
+	bool reduced = false;
+	if (argc < 3)
+		return usage();
+	dir = tableDir(argv[2]);
+	for (i = 3; i < argc; ++i)
+		if (std::string(argv[i]) == "-s")
+			reduced = true;
+		else if (std::string(argv[i]) == "-m" && i + 1 < argc)
+			moves = parseMoveSet(argv[++i]);
+		else
+			specs.push_back(argv[i]);
+	if (specs.empty())
+		specs = defaultPatterns();
+	for (i = 0; i < (int)specs.size(); ++i)
+	{
+		pruningTable table(patternCoord(specs[i]), moves, 0, 0, reduced);
+		start = std::chrono::steady_clock::now();
+		table.generate();
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << table.pattern().name() << ": " << table.size() << " indices, depth "
+			<< table.depth() << ", " << seconds << " s" << std::endl;
+		if (!table.save(dir + table.fileName()))
+		{
+			std::cout << "cannot write " << dir + table.fileName() << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Reads a state as written by formatState, or else as a scramble from solved.
+static octaState readState(const std::string& line)
+{
+	octaState s;
+	if (!parseState(line, s))
+		s = compileSequence(parseMoves(line));
+	return s;
+}
+
+static void solveFast(const std::string& dir, std::istream& in, double seconds)
+{
+	multiPhaseSolver solver(defaultPhases(), dir);
+	octaState s;
+	std::vector<int> solution;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		try
+		{
+			s = readState(line);
+			solution = solver.solve(s, seconds);
+			if (solution.empty() && !s.solved())
+				std::cout << "no solution within the time limit" << std::endl;
+			else
+				std::cout << formatMoves(solution) << " (" << solution.size() << ")" << std::endl;
+		}
+		catch (std::exception& e)
+		{
+			std::cout << "error: " << e.what() << std::endl;
+		}
+	}
+}
+
+static int solveStates(int argc, char* argv[])
+{
+	pruningSet tables;
+	std::vector<std::string> specs = defaultPatterns(), group;
+	std::ifstream file;
+	std::string dir, line, arg;
+	std::vector<int> solution;
+	uint64_t moves = allMoves;
+	size_t i, j;
+	int a, threads = 0;
+	double seconds = 0;
+	bool deterministic = false, reduced = false, fast = false, optimal = false;
+	if (argc < 3)
+		return usage();
+	dir = tableDir(argv[2]);
+	for (a = 3; a < argc; ++a)
+	{
+		arg = argv[a];
+		optimal |= arg == "-t" || arg == "-d" || arg == "-s" || arg == "-m" || arg == "-a";
+		if (arg == "-t" && a + 1 < argc)
+			threads = std::stoi(argv[++a]);
+		else if (arg == "-d")
+			deterministic = true;
+		else if (arg == "-s")
+			reduced = true;
+		else if (arg == "-m" && a + 1 < argc)
+			moves = parseMoveSet(argv[++a]);
+		else if (arg == "-a" && a + 1 < argc)
+		{
+			arg = argv[++a];
+			for (i = 0; i <= arg.size(); i = j + 1)
+			{
+				j = std::min(arg.find(';', i), arg.size());
+				group.push_back(arg.substr(i, j - i));
+			}
+		}
+		else if (arg == "-f" && a + 1 < argc)
+		{
+			fast = true;
+			seconds = std::stod(argv[++a]);
+		}
+		else
+		{
+			file.open(arg);
+			if (!file)
+			{
+				std::cout << "cannot read " << arg << std::endl;
+				return 1;
+			}
+		}
+	}
+	std::istream& in = file.is_open() ? file : std::cin;
+	if (fast)
+	{
+		if (optimal || !(seconds > 0))
+			return usage();
+		solveFast(dir, in, seconds);
+		return 0;
+	}
+	for (i = 0; i < specs.size(); ++i)
+		tables.add(specs[i], dir, moves, 0, reduced);
+	if (!group.empty())
+		tables.addGroup(group, dir, moves, {}, reduced);
+	optimalSolver solver(tables, threads, deterministic, moves);
+	while (std::getline(in, line))
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		try
+		{
+			solution = solver.solve(readState(line));
+			std::cout << formatMoves(solution) << " (" << solution.size() << ")" << std::endl;
+		}
+		catch (std::exception& e)
+		{
+			std::cout << "error: " << e.what() << std::endl;
+		}
+	}
+	return 0;
+}
+
+static int meetStates(int argc, char* argv[])
+{
+	std::ifstream file;
+	std::string arg, line;
+	std::vector<int> solution;
+	int a, threads = 0, bits = 23;
+	for (a = 2; a < argc; ++a)
+	{
+		arg = argv[a];
+		if (arg == "-t" && a + 1 < argc)
+			threads = std::stoi(argv[++a]);
+		else if (arg == "-c" && a + 1 < argc)
+			bits = std::stoi(argv[++a]);
+		else
+		{
+			file.open(arg);
+			if (!file)
+			{
+				std::cout << "cannot read " << arg << std::endl;
+				return 1;
+			}
+		}
+	}
+	if (bits < 6 || bits > 40)
+		return usage();
+	std::istream& in = file.is_open() ? file : std::cin;
+	bidirectionalSolver solver(threads, 1ull << bits);
+	while (std::getline(in, line))
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		try
+		{
+			solution = solver.solve(readState(line));
+			std::cout << formatMoves(solution) << " (" << solution.size() << ")" << std::endl;
+		}
+		catch (std::exception& e)
+		{
+			std::cout << "error: " << e.what() << std::endl;
+		}
+	}
+	return 0;
+}
+
+static int countStates(int argc, char* argv[])
+{
+	std::vector<uint64_t> histogram;
+	std::string arg, dir;
+	uint64_t moves = allMoves, shard = 0, total = 0;
+	size_t i;
+	int a, threads = 0;
+	if (argc < 3)
+		return usage();
+	for (a = 3; a < argc; ++a)
+	{
+		arg = argv[a];
+		if (arg == "-m" && a + 1 < argc)
+			moves = parseMoveSet(argv[++a]);
+		else if (arg == "-t" && a + 1 < argc)
+			threads = std::stoi(argv[++a]);
+		else if (arg == "-s" && a + 2 < argc)
+		{
+			shard = std::stoull(argv[++a]);
+			dir = tableDir(argv[++a]);
+		}
+		else
+			return usage();
+	}
+	stateCensus census(patternCoord(argv[2]), moves, threads);
+	if (shard)
+		census.useShards(shard, dir);
+	histogram = census.run();
+	for (i = 0; i < histogram.size(); ++i)
+	{
+		std::cout << i << " " << histogram[i] << std::endl;
+		total += histogram[i];
+	}
+	std::cout << "total " << total << std::endl;
+	return 0;
+}
+
+static int scrambleStates(int argc, char* argv[])
+{
+	std::unique_ptr<multiPhaseSolver> solver;
+	std::vector<int> solution;
+	std::string arg, dir;
+	uint64_t seed = std::random_device()();
+	double seconds = 0;
+	octaState s;
+	int a, i, count = 1;
+	for (a = 2; a < argc; ++a)
+	{
+		arg = argv[a];
+		if (arg == "-n" && a + 1 < argc)
+			count = std::stoi(argv[++a]);
+		else if (arg == "-s" && a + 1 < argc)
+			seed = std::stoull(argv[++a]);
+		else if (arg == "-f" && a + 2 < argc)
+		{
+			dir = tableDir(argv[++a]);
+			seconds = std::stod(argv[++a]);
+		}
+		else
+			return usage();
+	}
+	if (!dir.empty() && !(seconds > 0))
+		return usage();
+	if (!dir.empty())
+		solver.reset(new multiPhaseSolver(defaultPhases(), dir));
+	scrambler random(seed);
+	for (i = 0; i < count; ++i)
+	{
+		s = random.next();
+		std::cout << formatState(s) << std::endl;
+		if (!solver)
+			continue;
+		solution = solver->solve(s, seconds);
+		if (solution.empty() && !s.solved())
+			std::cout << "no sequence within the time limit" << std::endl;
+		else
+			std::cout << formatMoves(invertMoves(solution)) << std::endl;
+	}
+	return 0;
+}
+
+static int optimizeSequences(int argc, char* argv[])
+{
+	std::ifstream file;
+	std::string arg, line;
+	std::vector<int> seq, shorter;
+	int a, depth = 4;
+	for (a = 2; a < argc; ++a)
+	{
+		arg = argv[a];
+		if (arg == "-w" && a + 1 < argc)
+			depth = std::stoi(argv[++a]);
+		else
+		{
+			file.open(arg);
+			if (!file)
+			{
+				std::cout << "cannot read " << arg << std::endl;
+				return 1;
+			}
+		}
+	}
+	std::istream& in = file.is_open() ? file : std::cin;
+	sequenceOptimizer optimizer(depth);
+	while (std::getline(in, line))
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		try
+		{
+			seq = parseMoves(line);
+			shorter = optimizer.optimize(seq);
+			std::cout << formatMoves(shorter) << " (" << seq.size() << " -> " << shorter.size() << ")" << std::endl;
+		}
+		catch (std::exception& e)
+		{
+			std::cout << "error: " << e.what() << std::endl;
+		}
+	}
+	return 0;
+}
+
+static int findAlgorithm(int argc, char* argv[])
+{
+	std::vector<std::vector<int>> cycles;
+	std::vector<int> solution;
+	std::string arg;
+	size_t i, j;
+	int a, depth = 4, length = 9;
+	bool anyTwist = false;
+	for (a = 2; a < argc; ++a)
+	{
+		arg = argv[a];
+		if (arg == "-w" && a + 1 < argc)
+			depth = std::stoi(argv[++a]);
+		else if (arg == "-l" && a + 1 < argc)
+			length = std::stoi(argv[++a]);
+		else if (arg == "-o")
+			anyTwist = true;
+		else
+		{
+			cycles.push_back(std::vector<int>());
+			for (i = 0; i < arg.size(); i = j + 1)
+			{
+				j = std::min(arg.find(',', i), arg.size());
+				cycles.back().push_back(std::stoi(arg.substr(i, j - i)));
+			}
+		}
+	}
+	if (cycles.empty())
+		return usage();
+	algorithmFinder finder(depth);
+	solution = finder.find(cycleTargets(cycles, anyTwist), length);
+	if (solution.empty())
+		std::cout << "none within " << length << " moves" << std::endl;
+	else
+		std::cout << formatMoves(solution) << " (" << solution.size() << ")" << std::endl;
+	return 0;
+}
+
+static int groupInfo(int argc, char* argv[])
+{
+	std::ifstream file;
+	std::string arg, line;
+	uint64_t moves = allMoves;
+	int a, i;
+	octaState s;
+	for (a = 2; a < argc; ++a)
+	{
+		arg = argv[a];
+		if (arg == "-m" && a + 1 < argc)
+			moves = parseMoveSet(argv[++a]);
+		else
+		{
+			file.open(arg);
+			if (!file)
+			{
+				std::cout << "cannot read " << arg << std::endl;
+				return 1;
+			}
+		}
+	}
+	stabilizerChain chain(moves);
+	if (!file.is_open())
+	{
+		std::cout << "order " << chain.order() << std::endl;
+		for (i = 0; i < stabilizerChain::points; ++i)
+			if (chain.orbitSize(i) > 1)
+				std::cout << "point " << i << " orbit " << chain.orbitSize(i) << " stabilizer " << chain.stabilizerOrder(i + 1) << std::endl;
+		return 0;
+	}
+	while (std::getline(file, line))
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		try
+		{
+			s = readState(line);
+			std::cout << (chain.contains(s) ? "reachable" : "not reachable") << std::endl;
+		}
+		catch (std::exception& e)
+		{
+			std::cout << "error: " << e.what() << std::endl;
+		}
+	}
+	return 0;
+}
+
+int runTool(int argc, char* argv[])
+{
+	std::string mode = argv[1];
+	try
+	{
+		if (mode == "tables")
+			return makeTables(argc, argv);
+		if (mode == "solve")
+			return solveStates(argc, argv);
+		if (mode == "meet")
+			return meetStates(argc, argv);
+		if (mode == "count")
+			return countStates(argc, argv);
+		if (mode == "scramble")
+			return scrambleStates(argc, argv);
+		if (mode == "optimize")
+			return optimizeSequences(argc, argv);
+		if (mode == "find")
+			return findAlgorithm(argc, argv);
+		if (mode == "group")
+			return groupInfo(argc, argv);
+	}
+	catch (std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+	return usage();
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Command-line modes of the executable, used when it is started with
+// arguments instead of opening the window.
+int runTool(int argc, char* argv[]);